@@ -0,0 +1,256 @@
+#include "Approximate.h"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <limits>
+
+#include "Factorial.h"
+#include "Fibonacci.h"
+
+namespace
+{
+	// An unevaluated sum hi + lo with |lo| <= ulp(hi) / 2, the algorithms are the usual error-free
+	// transformations from the QD library
+	struct DoubleDouble
+	{
+		double hi = 0;
+		double lo = 0;
+	};
+
+	DoubleDouble quick_two_sum(const double a, const double b)
+	{
+		const double s = a + b;
+		return { s, b - (s - a) };
+	}
+
+	DoubleDouble two_sum(const double a, const double b)
+	{
+		const double s = a + b;
+		const double bb = s - a;
+		return { s, (a - (s - bb)) + (b - bb) };
+	}
+
+	DoubleDouble operator+(const DoubleDouble& a, const DoubleDouble& b)
+	{
+		DoubleDouble s = two_sum(a.hi, b.hi);
+		const DoubleDouble t = two_sum(a.lo, b.lo);
+		s = quick_two_sum(s.hi, s.lo + t.hi);
+		return quick_two_sum(s.hi, s.lo + t.lo);
+	}
+
+	DoubleDouble operator-(const DoubleDouble& a)
+	{
+		return { -a.hi, -a.lo };
+	}
+
+	DoubleDouble operator-(const DoubleDouble& a, const DoubleDouble& b)
+	{
+		return a + -b;
+	}
+
+	DoubleDouble operator*(const DoubleDouble& a, const DoubleDouble& b)
+	{
+		const double p = a.hi * b.hi;
+		const double e = std::fma(a.hi, b.hi, -p);
+		return quick_two_sum(p, e + (a.hi * b.lo + a.lo * b.hi));
+	}
+
+	DoubleDouble operator/(const DoubleDouble& a, const DoubleDouble& b)
+	{
+		const double q1 = a.hi / b.hi;
+		DoubleDouble r = a - b * DoubleDouble{ q1 };
+		const double q2 = r.hi / b.hi;
+		r = r - b * DoubleDouble{ q2 };
+		const double q3 = r.hi / b.hi;
+		return quick_two_sum(q1, q2) + DoubleDouble{ q3 };
+	}
+
+	DoubleDouble from_integer(const uint64_t n)
+	{
+		// Both halves are exact doubles, so the sum is the exact value
+		return two_sum(std::ldexp(static_cast<double>(n >> 32), 32), static_cast<double>(n & 0xFFFFFFFF));
+	}
+
+	DoubleDouble floor(const DoubleDouble& a)
+	{
+		const double hi = std::floor(a.hi);
+		if (hi != a.hi)
+			return { hi, 0 };
+		return quick_two_sum(hi, std::floor(a.lo));
+	}
+
+	constexpr DoubleDouble ln2 = { 6.931471805599453e-01, 2.3190468138462996e-17 };
+	constexpr DoubleDouble pi = { 3.141592653589793, 1.2246467991473532e-16 };
+
+	DoubleDouble exp(const DoubleDouble& a)
+	{
+		// e^a = 2^k * (e^(r / 512))^512 with |r| <= ln(2) / 2, the small exponential is a Taylor series
+		const double k = std::floor(a.hi / ln2.hi + 0.5);
+		DoubleDouble r = a - ln2 * DoubleDouble{ k };
+		r = { std::ldexp(r.hi, -9), std::ldexp(r.lo, -9) };
+
+		DoubleDouble term = r, sum = r;
+		for (int i = 2; i <= 10; ++i)
+		{
+			term = term * r / DoubleDouble{ static_cast<double>(i) };
+			sum = sum + term;
+		}
+		// (1 + s)^2 - 1 = 2s + s^2 keeps the small value away from 1 while squaring
+		for (int i = 0; i < 9; ++i)
+			sum = DoubleDouble{ 2 } * sum + sum * sum;
+		sum = sum + DoubleDouble{ 1 };
+		return { std::ldexp(sum.hi, static_cast<int>(k)), std::ldexp(sum.lo, static_cast<int>(k)) };
+	}
+
+	DoubleDouble log(const DoubleDouble& a)
+	{
+		// One Newton step on e^y = a from the double logarithm doubles the correct bits
+		const DoubleDouble y = { std::log(a.hi) };
+		return y + a * exp(-y) - DoubleDouble{ 1 };
+	}
+
+	DoubleDouble sqrt(const DoubleDouble& a)
+	{
+		const DoubleDouble s = { std::sqrt(a.hi) };
+		return s + (a - s * s) / (DoubleDouble{ 2 } * s);
+	}
+
+	const DoubleDouble ln10 = log(DoubleDouble{ 10 });
+
+	// B(2k) / (2k (2k - 1)) for k = 1..10, the coefficients of Stirling's series
+	constexpr std::array<std::pair<double, double>, 10> stirling = { {
+		{ 1, 12 }, { -1, 360 }, { 1, 1260 }, { -1, 1680 }, { 1, 1188 },
+		{ -691, 360360 }, { 1, 156 }, { -3617, 122400 }, { 43867, 244188 }, { -174611, 125400 }
+	} };
+
+	// Below this Stirling's series is not accurate to double-double precision, the factorial is then a direct product
+	constexpr uint64_t stirling_threshold = 64;
+
+	// ln(Gamma(z)) for z >= 64. The series is cut after the z^-19 term, the first one left out is below 1e-34
+	DoubleDouble log_gamma(const DoubleDouble& z)
+	{
+		const DoubleDouble half_log_two_pi = DoubleDouble{ 0.5 } * log(DoubleDouble{ 2 } * pi);
+		DoubleDouble result = (z - DoubleDouble{ 0.5 }) * log(z) - z + half_log_two_pi;
+		const DoubleDouble inverse = DoubleDouble{ 1 } / z;
+		const DoubleDouble inverse_squared = inverse * inverse;
+		DoubleDouble power = inverse;
+		for (const auto& [numerator, denominator] : stirling)
+		{
+			result = result + DoubleDouble{ numerator } * power / DoubleDouble{ denominator };
+			power = power * inverse_squared;
+		}
+		return result;
+	}
+
+	// Every operation above keeps a relative error near 2^-104, the few dozen of them add up to well below 2^-100
+	Magnitude make_magnitude(const DoubleDouble& value)
+	{
+		return { value.hi, value.lo, std::ldexp(std::abs(value.hi), -100) + 1e-30 };
+	}
+
+	// The fraction of log10 in double-double
+	DoubleDouble fraction(const double high, const double low)
+	{
+		const DoubleDouble value = { high, low };
+		return value - floor(value);
+	}
+}
+
+BigInt Magnitude::digit_count() const
+{
+	if (high_ == -std::numeric_limits<double>::infinity())
+		return 1;
+	const DoubleDouble whole = floor(DoubleDouble{ high_, low_ });
+	// whole.hi is an integer below 2^70 and whole.lo a small integer, both exact as 64-bit parts
+	int exponent;
+	const double mantissa = std::frexp(whole.hi, &exponent);
+	BigInt count = exponent > 53 ? BigInt(static_cast<uint64_t>(std::ldexp(mantissa, 53))) << (exponent - 53) : BigInt(static_cast<uint64_t>(whole.hi));
+	if (whole.lo >= 0)
+		count += static_cast<uint64_t>(whole.lo);
+	else
+		count -= static_cast<uint64_t>(-whole.lo);
+	return count += 1;
+}
+
+bool Magnitude::digit_count_exact() const
+{
+	// Only exactly 1 (0!, 1!, F(1) and F(2)) has a log10 of exactly 0, its fraction sits on the integer but the count is known
+	if ((high_ == 0 && low_ == 0) || high_ == -std::numeric_limits<double>::infinity())
+		return true;
+	const DoubleDouble f = fraction(high_, low_);
+	return f.hi > error_ && 1 - f.hi > error_;
+}
+
+int Magnitude::reliable_digits() const
+{
+	// The one digit of 0 is exact
+	if (high_ == -std::numeric_limits<double>::infinity())
+		return 1;
+	return std::max(0, static_cast<int>(-std::log10(error_ * ln10.hi)));
+}
+
+std::string Magnitude::leading_digits(int count) const
+{
+	count = std::min(count, reliable_digits());
+	if (high_ == -std::numeric_limits<double>::infinity())
+		return count > 0 ? "0" : "";
+	// A small value has fewer digits than the error bound allows, past them 10^fraction only gives zeros
+	const double log10_value = log10();
+	if (log10_value < count)
+		count = static_cast<int>(std::floor(log10_value)) + 1;
+	if (count <= 0)
+		return "";
+	// 10^fraction is in [1, 10), the digits come off it one at a time with one more to round on
+	DoubleDouble value = exp(fraction(high_, low_) * ln10);
+	std::string digits;
+	for (int i = 0; i <= count; ++i)
+	{
+		const int d = std::clamp(static_cast<int>(floor(value).hi), 0, 9);
+		digits += static_cast<char>('0' + d);
+		value = (value - DoubleDouble{ static_cast<double>(d) }) * DoubleDouble{ 10 };
+	}
+	const bool round_up = digits.back() >= '5';
+	digits.pop_back();
+	for (auto it = digits.rbegin(); round_up && it != digits.rend(); ++it)
+	{
+		if (*it != '9')
+		{
+			++*it;
+			return digits;
+		}
+		*it = '0';
+	}
+	// Every digit was a 9, 9.99... rounds up to 10.0...
+	if (round_up)
+		digits = '1' + std::string(count - 1, '0');
+	return digits;
+}
+
+Magnitude factorial_magnitude(const uint64_t n)
+{
+	if (n < stirling_threshold)
+	{
+		// From the exact 64-bit table, then a double-double product of the few factors above it
+		const uint64_t start = std::min<uint64_t>(n, factorial_table.size() - 1);
+		DoubleDouble value = from_integer(factorial_table[start]);
+		for (uint64_t i = start + 1; i <= n; ++i)
+			value = value * DoubleDouble{ static_cast<double>(i) };
+		return make_magnitude(log(value) / ln10);
+	}
+	return make_magnitude(log_gamma(from_integer(n) + DoubleDouble{ 1 }) / ln10);
+}
+
+Magnitude fibonacci_magnitude(const uint64_t n)
+{
+	// F(0) = 0, its log10 is -infinity with no error
+	if (n == 0)
+		return { -std::numeric_limits<double>::infinity(), 0, 0 };
+	if (n < fibonacci_table.size())
+		return make_magnitude(log(from_integer(fibonacci_table[n])) / ln10);
+
+	// F(n) = (phi^n - (-phi)^-n) / sqrt(5), from F(94) on the second term changes log10 by less than 1e-38
+	const DoubleDouble root5 = sqrt(DoubleDouble{ 5 });
+	const DoubleDouble log_phi = log((DoubleDouble{ 1 } + root5) / DoubleDouble{ 2 });
+	return make_magnitude((from_integer(n) * log_phi - log(root5)) / ln10);
+}
\ No newline at end of file
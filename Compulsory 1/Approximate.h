@@ -0,0 +1,43 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+
+#include "BigInt.h"
+
+// log10 of a huge value in double-double arithmetic (about 106 bits), enough to keep both the
+// integer part and a useful fraction of log10(n!) for every 64-bit n. The value 0 has a log10 of
+// -infinity and is exact, with the single digit 0
+class Magnitude
+{
+public:
+	Magnitude(double high, double low, double error) : high_(high), low_(low), error_(error) {}
+
+	// log10 of the value, rounded to a double
+	double log10() const { return high_ + low_; }
+
+	// Bound on the absolute error of log10, the relative error of the value is at most ln(10) times this
+	double error() const { return error_; }
+
+	// floor(log10) + 1, exact when digit_count_exact() holds
+	BigInt digit_count() const;
+	// False only if the fraction of log10 is within error of an integer, so the count could be off by one.
+	// The value 1 has a fraction of exactly 0 but is always exact, and so is 0
+	bool digit_count_exact() const;
+
+	// How many leading digits the error bound guarantees, up to one unit in the last of them
+	int reliable_digits() const;
+	// The first count digits, count is capped at reliable_digits() and at the digit count of the value
+	std::string leading_digits(int count) const;
+
+private:
+	double high_;
+	double low_;
+	double error_;
+};
+
+// log10(n!) from Stirling's series for log-gamma, O(1) for any n
+Magnitude factorial_magnitude(uint64_t n);
+
+// log10(F(n)) from Binet's formula, O(1) for any n
+Magnitude fibonacci_magnitude(uint64_t n);
\ No newline at end of file
@@ -0,0 +1,424 @@
+#include "Batch.h"
+
+#include <algorithm>
+#include <atomic>
+#include <charconv>
+#include <condition_variable>
+#include <cstdint>
+#include <exception>
+#include <map>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "Approximate.h"
+#include "Factorial.h"
+#include "Fibonacci.h"
+#include "Modular.h"
+
+namespace
+{
+	enum class Kind { Factorial, Fibonacci, Invalid };
+
+	struct Query
+	{
+		Kind kind;
+		uint64_t n;
+		std::string line;
+		std::string error; // Why an invalid query was rejected
+		uint64_t modulus = 0; // 0 for the exact value
+		bool approximate = false; // Only the magnitude, for any n
+	};
+
+	// A modular result is keyed by the modulus first, so the queries of one modulus are next to each other
+	using ModularKey = std::pair<uint64_t, uint64_t>;
+
+	// The largest n accepted, both values stay below 2^28 bits so their last multiplications still fit the
+	// number theoretic transform. 10^7! has 65.7 million digits and F(3 * 10^8) 62.7 million
+	constexpr uint64_t max_factorial = 10'000'000;
+	constexpr uint64_t max_fibonacci = 300'000'000;
+
+	// Queries this close to the previous Fibonacci query are reached by stepping instead of fast doubling
+	constexpr uint64_t fibonacci_step_limit = 64;
+
+	// Runs task(0) to task(count - 1) on one thread per core
+	template <typename Task>
+	void parallel_for(const size_t count, Task task)
+	{
+		const size_t threads = std::min<size_t>(count, std::max(1u, std::thread::hardware_concurrency()));
+		std::atomic<size_t> next = 0;
+		std::vector<std::thread> workers;
+		for (size_t t = 0; t < threads; ++t)
+		{
+			workers.emplace_back([&]
+			{
+				for (size_t i = next++; i < count; i = next++)
+					task(i);
+			});
+		}
+		for (auto& worker : workers)
+			worker.join();
+	}
+
+	// Only digits, so "-1" can not wrap around, and from_chars fails on values above 2^64 - 1
+	bool parse_number(const std::string& text, uint64_t& value)
+	{
+		if (text.empty() || text.find_first_not_of("0123456789") != std::string::npos)
+			return false;
+		const auto [end, error] = std::from_chars(text.data(), text.data() + text.size(), value);
+		return error == std::errc() && end == text.data() + text.size();
+	}
+
+	Query parse(const std::string& line)
+	{
+		std::istringstream stream(line);
+		std::string name, number, word, modulus_text;
+		uint64_t n, modulus = 0;
+		const bool approximate = stream >> name && name == "approx";
+		if (approximate)
+			stream >> name;
+		const bool valid = stream >> number && parse_number(number, n)
+			&& (!(stream >> word) || (word == "mod" && stream >> modulus_text && parse_number(modulus_text, modulus)))
+			&& (stream >> std::ws).eof();
+		if (valid && (name == "factorial" || name == "fibonacci"))
+		{
+			const Kind kind = name == "factorial" ? Kind::Factorial : Kind::Fibonacci;
+			if (approximate)
+			{
+				if (!word.empty())
+					return { Kind::Invalid, 0, line, "approx does not take a modulus" };
+				return { kind, n, line, "", 0, true };
+			}
+			if (!word.empty())
+			{
+				if (modulus == 0)
+					return { Kind::Invalid, 0, line, "M must be at least 1" };
+				return { kind, n, line, "", modulus };
+			}
+			const uint64_t limit = kind == Kind::Factorial ? max_factorial : max_fibonacci;
+			if (n > limit)
+				return { Kind::Invalid, 0, line, "n is above " + std::to_string(limit) };
+			return { kind, n, line };
+		}
+		return { Kind::Invalid, 0, line, "expected \"factorial N\" or \"fibonacci N\", optionally followed by \"mod M\" or after \"approx\"" };
+	}
+
+	// "d.ddd...eE (D digits)" with as many leading digits as the error bound of the magnitude guarantees
+	std::string describe(const Magnitude& magnitude)
+	{
+		const std::string leading = magnitude.leading_digits(magnitude.reliable_digits());
+		const BigInt count = magnitude.digit_count();
+		std::string text = leading.substr(0, 1);
+		if (leading.size() > 1)
+			text += '.' + leading.substr(1);
+		if (count != 1)
+			text += 'e' + (count - 1).to_string();
+		text += " (" + count.to_string() + (count == 1 ? " digit" : " digits");
+		return text + (magnitude.digit_count_exact() ? ")" : ", or one off)");
+	}
+
+	// The decimal value of every distinct key, filled in by the workers while the writer waits on it
+	template <typename Key>
+	class Results
+	{
+	public:
+		struct Slot
+		{
+			std::string value; // The error message when failed
+			bool ready = false;
+			bool failed = false;
+		};
+
+	private:
+		std::map<Key, Slot> slots;
+		std::mutex mutex;
+		std::condition_variable published;
+
+	public:
+		void add(const Key& key) { slots[key]; }
+
+		std::vector<Key> keys() const
+		{
+			std::vector<Key> result;
+			for (const auto& [key, _] : slots)
+				result.push_back(key);
+			return result;
+		}
+
+		void publish(const Key& key, std::string value, const bool failed = false)
+		{
+			{
+				std::lock_guard lock(mutex);
+				Slot& slot = slots.at(key);
+				slot.value = std::move(value);
+				slot.ready = true;
+				slot.failed = failed;
+			}
+			published.notify_all();
+		}
+
+		void fail(const Key& key, std::string message) { publish(key, std::move(message), true); }
+
+		bool is_ready(const Key& key)
+		{
+			std::lock_guard lock(mutex);
+			return slots.at(key).ready;
+		}
+
+		const Slot& wait(const Key& key)
+		{
+			std::unique_lock lock(mutex);
+			Slot& slot = slots.at(key);
+			published.wait(lock, [&] { return slot.ready; });
+			return slot;
+		}
+	};
+
+	// n! for every n in ns (sorted, distinct). The products of the gaps between neighbouring n are built in
+	// parallel, and whichever worker finishes the gap the chain waits for multiplies it onto the previous
+	// factorial and publishes that n, so a small n never waits for the gaps above it
+	void factorials(const std::vector<uint64_t>& ns, Results<uint64_t>& results)
+	{
+		std::vector<BigInt> values(ns.size());
+		std::vector<std::string> errors(ns.size());
+		std::vector<bool> built(ns.size(), false);
+		size_t chained = 0;
+		bool chaining = false;
+		std::mutex mutex;
+
+		// One worker at a time is on the chain, and it keeps going while the next gap is built
+		const auto extend = [&]
+		{
+			while (true)
+			{
+				size_t i;
+				{
+					std::lock_guard lock(mutex);
+					if (chaining || chained == ns.size() || !built[chained])
+						return;
+					chaining = true;
+					i = chained;
+				}
+				// A failed link fails every factorial above it
+				if (errors[i].empty() && i > 0 && !errors[i - 1].empty())
+					errors[i] = errors[i - 1];
+				try
+				{
+					if (errors[i].empty() && i > 0)
+						values[i] *= values[i - 1];
+				}
+				catch (const std::exception& e)
+				{
+					errors[i] = e.what();
+				}
+				{
+					std::lock_guard lock(mutex);
+					++chained;
+					chaining = false;
+				}
+
+				// values[i] is final, the next link only reads it, so the conversion runs off the chain
+				try
+				{
+					if (errors[i].empty())
+						results.publish(ns[i], values[i].to_string());
+				}
+				catch (const std::exception& e)
+				{
+					errors[i] = e.what();
+				}
+				if (!errors[i].empty())
+					results.fail(ns[i], errors[i]);
+			}
+		};
+
+		parallel_for(ns.size(), [&](const size_t i)
+		{
+			try
+			{
+				values[i] = i == 0 ? factorial(ns[0]) : product(ns[i - 1] + 1, ns[i]);
+			}
+			catch (const std::exception& e)
+			{
+				errors[i] = e.what();
+			}
+			{
+				std::lock_guard lock(mutex);
+				built[i] = true;
+			}
+			extend();
+		});
+	}
+
+	// F(n) for every n in ns (sorted, distinct). Runs of close n are one task that fast doubles to the
+	// first and steps to the rest
+	void fibonaccis(const std::vector<uint64_t>& ns, Results<uint64_t>& results)
+	{
+		std::vector<size_t> runs;
+		for (size_t i = 0; i < ns.size(); ++i)
+		{
+			if (i == 0 || ns[i] - ns[i - 1] > fibonacci_step_limit)
+				runs.push_back(i);
+		}
+		runs.push_back(ns.size());
+
+		parallel_for(runs.size() - 1, [&](const size_t run)
+		{
+			size_t i = runs[run];
+			try
+			{
+				FibonacciGenerator generator(ns[i]);
+				for (; i < runs[run + 1]; ++i)
+				{
+					while (generator.index() < ns[i])
+						generator.next();
+					results.publish(ns[i], generator.current().to_string());
+				}
+			}
+			catch (const std::exception& e)
+			{
+				// The rest of the run steps on from the value that failed
+				for (; i < runs[run + 1]; ++i)
+					results.fail(ns[i], e.what());
+			}
+		});
+	}
+
+	// n! or F(n) modulo m for every (m, n) in keys (sorted). Every modulus is one task, so its queries share
+	// one context and the factorials among them extend each other
+	void modulars(const std::vector<ModularKey>& keys, const Kind kind, Results<ModularKey>& results)
+	{
+		std::vector<size_t> groups;
+		for (size_t i = 0; i < keys.size(); ++i)
+		{
+			if (i == 0 || keys[i].first != keys[i - 1].first)
+				groups.push_back(i);
+		}
+		groups.push_back(keys.size());
+
+		parallel_for(groups.size() - 1, [&](const size_t group)
+		{
+			const uint64_t m = keys[groups[group]].first;
+			try
+			{
+				const modular::ModularContext context(m);
+				std::vector<uint64_t> ns;
+				for (size_t i = groups[group]; i < groups[group + 1]; ++i)
+				{
+					// Rejected before any work is done, so the other queries of the modulus still get answered
+					if (kind == Kind::Factorial && !context.factorial_in_range(keys[i].second))
+						results.fail(keys[i], "n is too large for a factorial modulo " + std::to_string(m));
+					else
+						ns.push_back(keys[i].second);
+				}
+				const auto values = kind == Kind::Factorial ? context.factorials(ns) : context.fibonaccis(ns);
+				for (size_t i = 0; i < ns.size(); ++i)
+					results.publish({ m, ns[i] }, std::to_string(values[i]));
+			}
+			catch (const std::exception& e)
+			{
+				for (size_t i = groups[group]; i < groups[group + 1]; ++i)
+				{
+					if (!results.is_ready(keys[i]))
+						results.fail(keys[i], e.what());
+				}
+			}
+		});
+	}
+}
+
+int batch_main(std::istream& in, std::ostream& out)
+{
+	std::vector<Query> queries;
+	Results<uint64_t> factorial_results, fibonacci_results;
+	Results<ModularKey> modular_factorial_results, modular_fibonacci_results;
+	for (std::string line; std::getline(in, line);)
+	{
+		if (line.find_first_not_of(" \t\r") == std::string::npos)
+			continue;
+		const Query& query = queries.emplace_back(parse(line));
+		if (query.kind == Kind::Invalid || query.approximate)
+			continue;
+		if (query.modulus != 0)
+			(query.kind == Kind::Factorial ? modular_factorial_results : modular_fibonacci_results).add({ query.modulus, query.n });
+		else
+			(query.kind == Kind::Factorial ? factorial_results : fibonacci_results).add(query.n);
+	}
+
+	// Every kind is computed in the background while the results are written in input order as they become ready
+	std::jthread factorial_worker([&] { factorials(factorial_results.keys(), factorial_results); });
+	std::jthread fibonacci_worker([&] { fibonaccis(fibonacci_results.keys(), fibonacci_results); });
+	std::jthread modular_factorial_worker([&] { modulars(modular_factorial_results.keys(), Kind::Factorial, modular_factorial_results); });
+	std::jthread modular_fibonacci_worker([&] { modulars(modular_fibonacci_results.keys(), Kind::Fibonacci, modular_fibonacci_results); });
+
+	// Written in large blocks instead of one flush per line, and whenever the next result is not ready yet
+	constexpr size_t block_size = 1 << 20;
+	std::string buffer;
+	buffer.reserve(block_size);
+	const auto flush = [&]
+	{
+		out.write(buffer.data(), static_cast<std::streamsize>(buffer.size()));
+		out.flush();
+		buffer.clear();
+	};
+	int status = 0;
+	const auto write = [&](const std::string& label, auto& results, const auto& key)
+	{
+		if (!results.is_ready(key))
+			flush();
+		const auto& slot = results.wait(key);
+		if (slot.failed)
+		{
+			buffer += label + " failed: " + slot.value + '\n';
+			status = 1;
+		}
+		else
+			buffer += label + " = " + slot.value + '\n';
+	};
+
+	for (const auto& query : queries)
+	{
+		const std::string label = (query.kind == Kind::Factorial ? "factorial " : "fibonacci ") + std::to_string(query.n);
+		if (query.approximate)
+		{
+			// O(1) each, so they are answered here instead of on a worker
+			try
+			{
+				const Magnitude magnitude = query.kind == Kind::Factorial ? factorial_magnitude(query.n) : fibonacci_magnitude(query.n);
+				buffer += "approx " + label + " = " + describe(magnitude) + '\n';
+			}
+			catch (const std::exception& e)
+			{
+				buffer += "approx " + label + " failed: " + e.what() + '\n';
+				status = 1;
+			}
+			continue;
+		}
+		switch (query.kind)
+		{
+		case Kind::Factorial:
+			if (query.modulus != 0)
+				write(label + " mod " + std::to_string(query.modulus), modular_factorial_results, ModularKey{ query.modulus, query.n });
+			else
+				write(label, factorial_results, query.n);
+			break;
+		case Kind::Fibonacci:
+			if (query.modulus != 0)
+				write(label + " mod " + std::to_string(query.modulus), modular_fibonacci_results, ModularKey{ query.modulus, query.n });
+			else
+				write(label, fibonacci_results, query.n);
+			break;
+		case Kind::Invalid:
+			buffer += "invalid query: " + query.line + " (" + query.error + ")\n";
+			status = 1;
+			break;
+		}
+		if (buffer.size() >= block_size)
+			flush();
+	}
+	flush();
+	return status;
+}
\ No newline at end of file
@@ -0,0 +1,15 @@
+#pragma once
+
+#include <istream>
+#include <ostream>
+
+// Answers "factorial N" and "fibonacci N" queries, one per line, without any prompts. The queries
+// are deduplicated and sorted so neighbouring ones share work, evaluated in parallel and written
+// in input order as "factorial N = value", each as soon as it is computed. N has to be a plain
+// number up to 10^7 for factorials and 3 * 10^8 for Fibonacci numbers. "factorial N mod M" and
+// "fibonacci N mod M" take any 64-bit N and M >= 1 and answer modulo M, the queries of one M share
+// a modular context. "approx factorial N" and "approx fibonacci N" take any 64-bit N and give the
+// leading digits and the digit count from the magnitude, as "approx factorial 100 = 9.3326...e157 (158 digits)".
+// A query whose computation throws, or a modular factorial too large for it, is written as
+// "factorial N failed: reason". Returns the exit code, 1 if a line was invalid or failed
+int batch_main(std::istream& in, std::ostream& out);
\ No newline at end of file
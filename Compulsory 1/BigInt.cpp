@@ -0,0 +1,529 @@
+#include "BigInt.h"
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <functional>
+#include <future>
+#include <span>
+#include <stdexcept>
+#include <thread>
+#include <utility>
+
+#include "Ntt.h"
+
+namespace
+{
+	using Limbs = std::vector<uint32_t>;
+	using View = std::span<const uint32_t>;
+
+	// Operand sizes in limbs where the next multiplication algorithm starts to win
+	constexpr size_t karatsuba_threshold = 32;
+	constexpr size_t ntt_threshold = 1536;
+
+	View trimmed(View v)
+	{
+		while (!v.empty() && v.back() == 0)
+			v = v.first(v.size() - 1);
+		return v;
+	}
+
+	void trim(Limbs& r)
+	{
+		while (!r.empty() && r.back() == 0)
+			r.pop_back();
+	}
+
+	// r += x * 2^(32 * shift)
+	void add_to(Limbs& r, const View x, const size_t shift)
+	{
+		if (r.size() < shift + x.size())
+			r.resize(shift + x.size());
+		uint64_t carry = 0;
+		size_t i = 0;
+		for (; i < x.size(); ++i)
+		{
+			carry += static_cast<uint64_t>(r[shift + i]) + x[i];
+			r[shift + i] = static_cast<uint32_t>(carry);
+			carry >>= 32;
+		}
+		for (i += shift; carry != 0; ++i)
+		{
+			if (i == r.size())
+				r.push_back(0);
+			carry += r[i];
+			r[i] = static_cast<uint32_t>(carry);
+			carry >>= 32;
+		}
+	}
+
+	// r -= x, r must be at least x
+	void sub_from(Limbs& r, const View x)
+	{
+		int64_t borrow = 0;
+		size_t i = 0;
+		for (; i < x.size(); ++i)
+		{
+			borrow += static_cast<int64_t>(r[i]) - x[i];
+			r[i] = static_cast<uint32_t>(borrow);
+			borrow >>= 32;
+		}
+		for (; borrow != 0; ++i)
+		{
+			borrow += r[i];
+			r[i] = static_cast<uint32_t>(borrow);
+			borrow >>= 32;
+		}
+	}
+
+	Limbs add(const View a, const View b)
+	{
+		Limbs r(a.begin(), a.end());
+		add_to(r, b, 0);
+		return r;
+	}
+
+	Limbs schoolbook(const View a, const View b)
+	{
+		Limbs r(a.size() + b.size());
+		for (size_t i = 0; i < a.size(); ++i)
+		{
+			uint64_t carry = 0;
+			for (size_t j = 0; j < b.size(); ++j)
+			{
+				carry += static_cast<uint64_t>(a[i]) * b[j] + r[i + j];
+				r[i + j] = static_cast<uint32_t>(carry);
+				carry >>= 32;
+			}
+			r[i + b.size()] = static_cast<uint32_t>(carry);
+		}
+		return r;
+	}
+
+	// The products go through number theoretic transforms over the 32-bit limbs modulo three primes.
+	// Every coefficient of the convolution is below min(a, b) * 2^64 <= 2^86, which is less than
+	// prime1 * prime2 * prime3, so Garner's form of the Chinese remainder theorem gives the exact value back
+	constexpr std::array<uint32_t, 3> ntt_primes = { ntt::prime1, ntt::prime2, ntt::prime3 };
+
+	Limbs combine(const std::array<std::vector<uint32_t>, 3>& residues)
+	{
+		const auto& [c1, c2, c3] = residues;
+		// x = c1 + prime1 * t2 + prime1 * prime2 * t3 with t2 < prime2 and t3 < prime3
+		const uint64_t p12 = uint64_t{ntt::prime1} * ntt::prime2;
+		const uint64_t inverse2 = ntt::pow_mod(ntt::prime1 % ntt::prime2, ntt::prime2 - 2, ntt::prime2);
+		const uint64_t inverse3 = ntt::pow_mod(static_cast<uint32_t>(p12 % ntt::prime3), ntt::prime3 - 2, ntt::prime3);
+		Limbs r(c1.size() + 2);
+		// The part of the sum that belongs to limb i and above, it stays below 2^57
+		uint64_t carry = 0;
+		for (size_t i = 0; i < c1.size(); ++i)
+		{
+			const uint64_t t2 = (c2[i] + ntt::prime2 - c1[i] % ntt::prime2) % ntt::prime2 * inverse2 % ntt::prime2;
+			const uint64_t x12 = c1[i] + ntt::prime1 * t2;
+			const uint64_t t3 = (c3[i] + ntt::prime3 - x12 % ntt::prime3) % ntt::prime3 * inverse3 % ntt::prime3;
+			// p12 * t3 is split at 32 bits so every partial sum fits in 64 bits
+			const uint64_t low = t3 * (p12 & 0xFFFFFFFF);
+			const uint64_t high = t3 * (p12 >> 32);
+			const uint64_t sum = (x12 & 0xFFFFFFFF) + (low & 0xFFFFFFFF) + carry;
+			r[i] = static_cast<uint32_t>(sum);
+			carry = (sum >> 32) + (x12 >> 32) + (low >> 32) + high;
+		}
+		for (size_t i = c1.size(); carry != 0; ++i)
+		{
+			r[i] = static_cast<uint32_t>(carry);
+			carry >>= 32;
+		}
+		return r;
+	}
+
+	Limbs multiply_ntt(const View a, const View b)
+	{
+		const std::vector<uint32_t> va(a.begin(), a.end());
+		// A square passes the same vector twice, which saves one of the forward transforms
+		const bool square = a.data() == b.data() && a.size() == b.size();
+		const std::vector<uint32_t> vb = square ? std::vector<uint32_t>() : std::vector<uint32_t>(b.begin(), b.end());
+		std::array<std::vector<uint32_t>, 3> residues;
+		for (size_t k = 0; k < ntt_primes.size(); ++k)
+			residues[k] = ntt::convolve(va, square ? va : vb, ntt_primes[k]);
+		return combine(residues);
+	}
+
+	Limbs multiply(View a, View b);
+
+	// a is the longer operand and b has more than half its length
+	Limbs karatsuba(const View a, const View b)
+	{
+		const size_t m = a.size() / 2;
+		const View a0 = trimmed(a.first(m)), a1 = a.subspan(m);
+		const View b0 = trimmed(b.first(m)), b1 = b.subspan(m);
+		const Limbs z0 = multiply(a0, b0);
+		const Limbs z2 = multiply(a1, b1);
+		Limbs z1 = multiply(add(a0, a1), add(b0, b1));
+		sub_from(z1, z0);
+		sub_from(z1, z2);
+
+		Limbs r(a.size() + b.size());
+		add_to(r, z0, 0);
+		add_to(r, trimmed(z1), m);
+		add_to(r, z2, 2 * m);
+		return r;
+	}
+
+	Limbs multiply(View a, View b)
+	{
+		a = trimmed(a);
+		b = trimmed(b);
+		if (a.size() < b.size())
+			std::swap(a, b);
+		if (b.empty())
+			return {};
+
+		Limbs r;
+		if (b.size() < karatsuba_threshold)
+			r = schoolbook(a, b);
+		else if (b.size() >= ntt_threshold && a.size() + b.size() <= ntt::max_length)
+			r = multiply_ntt(a, b);
+		else if (2 * b.size() <= a.size())
+		{
+			// Cut the longer operand into pieces of the shorter one so Karatsuba stays balanced
+			for (size_t offset = 0; offset < a.size(); offset += b.size())
+				add_to(r, multiply(a.subspan(offset, std::min(b.size(), a.size() - offset)), b), offset);
+		}
+		else
+			r = karatsuba(a, b);
+		trim(r);
+		return r;
+	}
+}
+
+namespace
+{
+	// A value at most 4 below floor(2^(2n) / a) where a has n bits, by Newton's iteration
+	// r = 2r - a r^2 / 2^(2n) from the reciprocal of the top half of a, which doubles the correct bits.
+	// The iteration approaches from below, rounding down by 2 more keeps it there, and the 3 guard bits of
+	// the top half keep the error from growing, so no step needs the full product r * a to correct it
+	BigInt reciprocal(const BigInt& a)
+	{
+		const size_t n = a.bit_length();
+		if (n < 32)
+			return (uint64_t{1} << 2 * n) / a.limbs()[0];
+
+		// r0 = rh * 2^(n - h) for the reciprocal rh of the top h bits, so r0^2 only needs an h-bit square
+		const size_t h = n / 2 + 3;
+		const BigInt rh = reciprocal(a >> (n - h));
+		const BigInt correction = (a * (rh * rh) >> 2 * h) + 2;
+		const BigInt r = rh << (n - h + 1);
+		return r > correction ? r - correction : BigInt(1);
+	}
+
+	// A factor that many products share. Above the NTT threshold its transforms are done once, at a
+	// length that fits the product with any operand of up to other_bits bits
+	struct SharedFactor
+	{
+		BigInt value;
+		std::array<std::vector<uint32_t>, 3> transforms;
+
+		SharedFactor(BigInt factor, const size_t other_bits) : value(std::move(factor))
+		{
+			const size_t size = value.limbs().size();
+			const size_t other = (other_bits + 31) / 32;
+			if (std::min(size, other) < ntt_threshold || size + other > ntt::max_length)
+				return;
+			for (size_t k = 0; k < ntt_primes.size(); ++k)
+				transforms[k] = ntt::forward(value.limbs(), std::bit_ceil(size + other - 1), ntt_primes[k]);
+		}
+
+		// x * value, with the same choice of algorithm as any other product
+		BigInt product(const BigInt& x) const
+		{
+			const size_t size = x.limbs().size() + value.limbs().size() - 1;
+			if (transforms[0].empty() || x.limbs().size() < ntt_threshold || size > transforms[0].size())
+				return x * value;
+			std::array<std::vector<uint32_t>, 3> residues;
+			for (size_t k = 0; k < ntt_primes.size(); ++k)
+				residues[k] = ntt::convolve_transformed(x.limbs(), transforms[k], size, ntt_primes[k]);
+			return BigInt::from_limbs(combine(residues));
+		}
+	};
+
+	// A divisor with its reciprocal, x / value is then a multiplication and a shift for x < 2^(2 bits).
+	// Both products in divide have an operand of at most bits + 1 bits, so both factors are shared
+	struct BarrettDivisor
+	{
+		size_t bits;
+		SharedFactor value;
+		SharedFactor reciprocal;
+
+		explicit BarrettDivisor(const BigInt& divisor) : bits(divisor.bit_length()), value(divisor, bits + 1), reciprocal(::reciprocal(divisor), bits + 1)
+		{
+		}
+
+		// Returns x / value and leaves x % value in x. Only the top bits + 1 bits of x take part in the
+		// estimate, which with the reciprocal keeps it at most 8 below the quotient
+		BigInt divide(BigInt& x) const
+		{
+			BigInt q = reciprocal.product(x >> (bits - 1)) >> (bits + 1);
+			x -= value.product(q);
+			while (x >= value.value)
+			{
+				x -= value.value;
+				q += 1;
+			}
+			return q;
+		}
+	};
+
+	// Exactly width digits of x, zero padded, by repeated division by 10^9
+	void write_digits(BigInt x, char* out, size_t width)
+	{
+		while (width > 0)
+		{
+			uint32_t chunk = x.divmod(1000000000);
+			for (int i = 0; i < 9 && width > 0; ++i)
+			{
+				out[--width] = static_cast<char>('0' + chunk % 10);
+				chunk /= 10;
+			}
+		}
+	}
+
+	// Writes x < powers[k]^2 as exactly block * 2^(k + 1) digits, with powers[k] = 10^(block * 2^k): the
+	// quotient by powers[k] goes to the upper half and the remainder to the lower half. The small levels are plain base 10^9 conversion,
+	// and the first depth levels write their upper half on another thread
+	void write_split(BigInt x, const std::vector<BarrettDivisor>& powers, const size_t block, const size_t k, char* out, const int depth)
+	{
+		const size_t half = block << k;
+		if (k < 3)
+		{
+			write_digits(std::move(x), out, 2 * half);
+			return;
+		}
+		BigInt q = powers[k].divide(x);
+		if (depth > 0)
+		{
+			auto upper = std::async(std::launch::async, write_split, std::move(q), std::cref(powers), block, k - 1, out, depth - 1);
+			write_split(std::move(x), powers, block, k - 1, out + half, depth - 1);
+			upper.get();
+			return;
+		}
+		write_split(std::move(q), powers, block, k - 1, out, 0);
+		write_split(std::move(x), powers, block, k - 1, out + half, 0);
+	}
+}
+
+BigInt::BigInt(const uint64_t value)
+{
+	limbs_ = { static_cast<uint32_t>(value), static_cast<uint32_t>(value >> 32) };
+	trim();
+}
+
+BigInt BigInt::from_words(const uint64_t low, const uint64_t high)
+{
+	BigInt r;
+	r.limbs_ = { static_cast<uint32_t>(low), static_cast<uint32_t>(low >> 32), static_cast<uint32_t>(high), static_cast<uint32_t>(high >> 32) };
+	r.trim();
+	return r;
+}
+
+BigInt BigInt::from_limbs(std::vector<uint32_t> limbs)
+{
+	BigInt r;
+	r.limbs_ = std::move(limbs);
+	r.trim();
+	return r;
+}
+
+size_t BigInt::bit_length() const
+{
+	if (limbs_.empty())
+		return 0;
+	return limbs_.size() * 32 - std::countl_zero(limbs_.back());
+}
+
+BigInt& BigInt::operator+=(const BigInt& other)
+{
+	add_to(limbs_, other.limbs_, 0);
+	return *this;
+}
+
+BigInt& BigInt::operator-=(const BigInt& other)
+{
+	sub_from(limbs_, other.limbs_);
+	trim();
+	return *this;
+}
+
+BigInt& BigInt::operator*=(const BigInt& other)
+{
+	limbs_ = multiply(limbs_, other.limbs_);
+	return *this;
+}
+
+BigInt& BigInt::operator*=(const uint32_t factor)
+{
+	if (factor == 0)
+	{
+		limbs_.clear();
+		return *this;
+	}
+	uint64_t carry = 0;
+	for (auto& limb : limbs_)
+	{
+		carry += static_cast<uint64_t>(limb) * factor;
+		limb = static_cast<uint32_t>(carry);
+		carry >>= 32;
+	}
+	if (carry != 0)
+		limbs_.push_back(static_cast<uint32_t>(carry));
+	return *this;
+}
+
+BigInt& BigInt::operator<<=(const size_t bits)
+{
+	if (limbs_.empty())
+		return *this;
+	const size_t words = bits / 32;
+	const unsigned shift = bits % 32;
+	if (shift != 0)
+	{
+		uint32_t carry = 0;
+		for (auto& limb : limbs_)
+		{
+			const uint32_t next = limb >> (32 - shift);
+			limb = limb << shift | carry;
+			carry = next;
+		}
+		if (carry != 0)
+			limbs_.push_back(carry);
+	}
+	limbs_.insert(limbs_.begin(), words, 0);
+	return *this;
+}
+
+BigInt& BigInt::operator>>=(const size_t bits)
+{
+	const size_t words = bits / 32;
+	if (words >= limbs_.size())
+	{
+		limbs_.clear();
+		return *this;
+	}
+	limbs_.erase(limbs_.begin(), limbs_.begin() + static_cast<std::ptrdiff_t>(words));
+	const unsigned shift = bits % 32;
+	if (shift != 0)
+	{
+		for (size_t i = 0; i + 1 < limbs_.size(); ++i)
+			limbs_[i] = limbs_[i] >> shift | limbs_[i + 1] << (32 - shift);
+		limbs_.back() >>= shift;
+	}
+	trim();
+	return *this;
+}
+
+BigInt operator*(const BigInt& a, const BigInt& b)
+{
+	BigInt r;
+	r.limbs_ = multiply(a.limbs_, b.limbs_);
+	return r;
+}
+
+std::strong_ordering operator<=>(const BigInt& a, const BigInt& b)
+{
+	if (a.limbs_.size() != b.limbs_.size())
+		return a.limbs_.size() <=> b.limbs_.size();
+	return std::lexicographical_compare_three_way(a.limbs_.rbegin(), a.limbs_.rend(), b.limbs_.rbegin(), b.limbs_.rend());
+}
+
+uint32_t BigInt::divmod(const uint32_t divisor)
+{
+	uint64_t remainder = 0;
+	for (auto it = limbs_.rbegin(); it != limbs_.rend(); ++it)
+	{
+		remainder = remainder << 32 | *it;
+		*it = static_cast<uint32_t>(remainder / divisor);
+		remainder %= divisor;
+	}
+	trim();
+	return static_cast<uint32_t>(remainder);
+}
+
+BigInt BigInt::divmod(const BigInt& divisor)
+{
+	if (divisor.is_zero())
+		throw std::domain_error("Division by zero");
+	if (*this < divisor)
+		return std::exchange(*this, BigInt());
+
+	// Long division in blocks of as many bits as the divisor, every step divides a value below
+	// 2^(2 bits) so one reciprocal serves them all
+	const BarrettDivisor barrett(divisor);
+	const size_t s = barrett.bits;
+	const size_t blocks = (bit_length() + s - 1) / s;
+	BigInt quotient, remainder;
+	for (size_t i = blocks; i-- > 0;)
+	{
+		remainder <<= s;
+		remainder += (*this >> i * s).low_bits(s);
+		quotient <<= s;
+		quotient += barrett.divide(remainder);
+	}
+	*this = std::move(quotient);
+	return remainder;
+}
+
+std::string BigInt::to_string() const
+{
+	if (limbs_.empty())
+		return "0";
+	if (limbs_.size() <= 32)
+	{
+		std::string out(limbs_.size() * 10, '0');
+		write_digits(*this, out.data(), out.size());
+		return out.substr(out.find_first_not_of('0'));
+	}
+
+	// The value has at most digits digits. The block is picked in [19, 38] so that block * 2^(k + 1) just
+	// covers them, which splits the top level near the middle instead of wasting up to half of it on zeros
+	const size_t digits = bit_length() * 30103 / 100000 + 1;
+	size_t k = 0;
+	while (19 * (size_t{4} << k) <= digits)
+		++k;
+	const size_t block = (digits + (size_t{2} << k) - 1) / (size_t{2} << k);
+
+	// powers[j] = 10^(block * 2^j)
+	BigInt power = 1;
+	for (size_t i = 0; i < block; ++i)
+		power *= 10;
+	std::vector<BarrettDivisor> powers;
+	for (size_t j = 0; j < k; ++j)
+	{
+		BigInt square = power * power;
+		powers.emplace_back(std::move(power));
+		power = std::move(square);
+	}
+	powers.emplace_back(std::move(power));
+
+	std::string out(block << (k + 1), '0');
+	write_split(*this, powers, block, k, out.data(), std::bit_width(std::max(1u, std::thread::hardware_concurrency())));
+	return out.substr(out.find_first_not_of('0'));
+}
+
+std::ostream& operator<<(std::ostream& os, const BigInt& value)
+{
+	return os << value.to_string();
+}
+
+void BigInt::trim()
+{
+	::trim(limbs_);
+}
+
+BigInt BigInt::low_bits(const size_t bits) const
+{
+	BigInt r;
+	const size_t words = (bits + 31) / 32;
+	r.limbs_.assign(limbs_.begin(), limbs_.begin() + static_cast<std::ptrdiff_t>(std::min(words, limbs_.size())));
+	if (bits % 32 != 0 && r.limbs_.size() == words)
+		r.limbs_.back() &= (uint32_t{1} << bits % 32) - 1;
+	r.trim();
+	return r;
+}
\ No newline at end of file
@@ -0,0 +1,59 @@
+#pragma once
+
+#include <compare>
+#include <cstddef>
+#include <cstdint>
+#include <ostream>
+#include <string>
+#include <vector>
+
+// Non-negative integer of any size, stored as little endian 32-bit limbs without leading zero limbs
+class BigInt
+{
+public:
+	BigInt() = default;
+	BigInt(uint64_t value);
+	// low + high * 2^64
+	static BigInt from_words(uint64_t low, uint64_t high);
+	// Little endian 32-bit limbs, leading zero limbs are dropped
+	static BigInt from_limbs(std::vector<uint32_t> limbs);
+
+	bool is_zero() const { return limbs_.empty(); }
+	size_t bit_length() const;
+	const std::vector<uint32_t>& limbs() const { return limbs_; }
+
+	BigInt& operator+=(const BigInt& other);
+	// Requires *this >= other
+	BigInt& operator-=(const BigInt& other);
+	BigInt& operator*=(const BigInt& other);
+	BigInt& operator*=(uint32_t factor);
+	BigInt& operator<<=(size_t bits);
+	BigInt& operator>>=(size_t bits);
+
+	friend BigInt operator+(BigInt a, const BigInt& b) { return a += b; }
+	friend BigInt operator-(BigInt a, const BigInt& b) { return a -= b; }
+	friend BigInt operator*(const BigInt& a, const BigInt& b);
+	friend BigInt operator*(BigInt a, const uint32_t b) { return a *= b; }
+	friend BigInt operator<<(BigInt a, const size_t bits) { return a <<= bits; }
+	friend BigInt operator>>(BigInt a, const size_t bits) { return a >>= bits; }
+
+	friend bool operator==(const BigInt& a, const BigInt& b) = default;
+	friend std::strong_ordering operator<=>(const BigInt& a, const BigInt& b);
+
+	// Divides by divisor in place and returns the remainder
+	uint32_t divmod(uint32_t divisor);
+	// Divides by divisor in place and returns the remainder, by Barrett reduction with a Newton reciprocal
+	BigInt divmod(const BigInt& divisor);
+
+	// Decimal digits, split recursively at 10^(block * 2^k) for a block of 19 to 38 digits, so the cost is
+	// that of a few large multiplications
+	std::string to_string() const;
+	friend std::ostream& operator<<(std::ostream& os, const BigInt& value);
+
+private:
+	std::vector<uint32_t> limbs_;
+
+	void trim();
+	// The value modulo 2^bits
+	BigInt low_bits(size_t bits) const;
+};
\ No newline at end of file
@@ -1,15 +1,35 @@
 // ConsoleApplication.cpp : This file contains the 'main' function. Program execution begins and ends there.
 //
 
+#include <fstream>
 #include <iostream>
 #include <ostream>
+#include <string>
 #include <thread>
 
+#include "Batch.h"
 #include "Factorial.h"
 #include "Fibonacci.h"
 
-int main()
+int main(int argc, char* argv[])
 {
+	// --batch [file] answers the queries in file, or stdin without one, and exits
+	if (argc > 1 && std::string(argv[1]) == "--batch")
+	{
+		std::ios::sync_with_stdio(false);
+		if (argc > 2)
+		{
+			std::ifstream file(argv[2]);
+			if (!file)
+			{
+				std::cerr << "Could not open " << argv[2] << std::endl;
+				return 1;
+			}
+			return batch_main(file, std::cout);
+		}
+		return batch_main(std::cin, std::cout);
+	}
+
 	char c;
 
 	while (true)
@@ -1,16 +1,78 @@
 #include <iostream>
 #include "Factorial.h"
 
+#include <algorithm>
+#include <bit>
+#include <future>
 #include <string>
+#include <thread>
 
-long double factorial(const unsigned long n)
+namespace
 {
-	if (n == 0)
+	// Product of lo..hi, or of only their odd parts, split in halves so both sides of every
+	// multiplication have about the same size. The first depth levels run their left half on another thread
+	BigInt tree_product(const uint64_t lo, const uint64_t hi, const int depth, const bool odd_parts)
 	{
-		return 1;
+		if (hi < lo)
+			return 1;
+		if (hi - lo < 32)
+		{
+			BigInt result = 1;
+			uint64_t acc = 1;
+			for (uint64_t i = lo; i <= hi; ++i)
+			{
+				const uint64_t term = odd_parts ? i >> std::countr_zero(i) : i;
+				if (term > UINT32_MAX)
+				{
+					result *= BigInt(term);
+					continue;
+				}
+				if (acc * term > UINT32_MAX)
+				{
+					result *= static_cast<uint32_t>(acc);
+					acc = 1;
+				}
+				acc *= term;
+			}
+			return result *= static_cast<uint32_t>(acc);
+		}
+		const uint64_t mid = lo + (hi - lo) / 2;
+		if (depth > 0)
+		{
+			auto left = std::async(std::launch::async, tree_product, lo, mid, depth - 1, odd_parts);
+			const BigInt right = tree_product(mid + 1, hi, depth - 1, odd_parts);
+			return left.get() * right;
+		}
+		return tree_product(lo, mid, 0, odd_parts) * tree_product(mid + 1, hi, 0, odd_parts);
 	}
-	const long double ret = factorial(n - 1);
-	return n * ret;
+
+	int parallel_depth()
+	{
+		return std::bit_width(std::max(1u, std::thread::hardware_concurrency()));
+	}
+}
+
+BigInt product(const uint64_t lo, const uint64_t hi)
+{
+	return tree_product(lo, hi, parallel_depth(), false);
+}
+
+BigInt factorial(const uint64_t n)
+{
+	if (n < factorial_table.size())
+	{
+		return factorial_table[n];
+	}
+#ifdef __SIZEOF_INT128__
+	if (n < factorial_table_128.size())
+	{
+		const unsigned __int128 value = factorial_table_128[n];
+		return BigInt::from_words(static_cast<uint64_t>(value), static_cast<uint64_t>(value >> 64));
+	}
+#endif
+	// n! = 2^(n - popcount(n)) * the odd parts of 1..n, the power of two is a shift at the end
+	BigInt ret = tree_product(1, n, parallel_depth(), true);
+	return ret <<= n - std::popcount(n);
 }
 
 void factorial_main()
@@ -1,5 +1,36 @@
 #pragma once
 
+#include <array>
+#include <cstdint>
+
+#include "BigInt.h"
+
+// 0! to 20!, every factorial that fits in 64 bits
+inline constexpr auto factorial_table = []
+{
+	std::array<uint64_t, 21> table{};
+	table[0] = 1;
+	for (uint64_t i = 1; i < table.size(); ++i)
+		table[i] = table[i - 1] * i;
+	return table;
+}();
+
+#ifdef __SIZEOF_INT128__
+// 0! to 34!, every factorial that fits in 128 bits
+inline constexpr auto factorial_table_128 = []
+{
+	std::array<unsigned __int128, 35> table{};
+	table[0] = 1;
+	for (unsigned i = 1; i < table.size(); ++i)
+		table[i] = table[i - 1] * i;
+	return table;
+}();
+#endif
+
 void factorial_main();
 
-long double factorial(unsigned long n);
\ No newline at end of file
+// Exact n!, a table lookup for the values that fit in a machine word
+BigInt factorial(uint64_t n);
+
+// lo * (lo + 1) * ... * hi, 1 for an empty range
+BigInt product(uint64_t lo, uint64_t hi);
\ No newline at end of file
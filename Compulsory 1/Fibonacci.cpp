@@ -1,15 +1,82 @@
 #include "Fibonacci.h"
 
+#include <bit>
 #include <iostream>
+#include <stdexcept>
 #include <string>
 
-static long double n1 = 0, n2 = 1, n3;
+namespace
+{
+	// The table entry for F(n), only valid when n is inside one of the tables
+	BigInt fibonacci_lookup(const uint64_t n)
+	{
+#ifdef __SIZEOF_INT128__
+		if (n >= fibonacci_table.size())
+		{
+			const unsigned __int128 value = fibonacci_table_128[n];
+			return BigInt::from_words(static_cast<uint64_t>(value), static_cast<uint64_t>(value >> 64));
+		}
+#endif
+		return fibonacci_table[n];
+	}
+
+#ifdef __SIZEOF_INT128__
+	constexpr uint64_t table_size = fibonacci_table_128.size();
+#else
+	constexpr uint64_t table_size = fibonacci_table.size();
+#endif
+}
+
+std::pair<BigInt, BigInt> fibonacci_pair(const uint64_t n)
+{
+	if (n < table_size - 1)
+		return { fibonacci_lookup(n), fibonacci_lookup(n + 1) };
+
+	// Fast doubling from the top bit down, with a = F(k) and b = F(k + 1):
+	// F(2k) = F(k) * (2F(k + 1) - F(k)) and F(2k + 1) = F(k)^2 + F(k + 1)^2
+	BigInt a = 0, b = 1;
+	for (int bit = std::bit_width(n) - 1; bit >= 0; --bit)
+	{
+		BigInt c = a * ((b << 1) - a);
+		BigInt d = a * a + b * b;
+		if (n >> bit & 1)
+		{
+			a = std::move(d);
+			b = std::move(c += a);
+		}
+		else
+		{
+			a = std::move(c);
+			b = std::move(d);
+		}
+	}
+	return { std::move(a), std::move(b) };
+}
+
+BigInt fibonacci(const uint64_t n)
+{
+	if (n < table_size)
+		return fibonacci_lookup(n);
+	return fibonacci_pair(n).first;
+}
+
+FibonacciGenerator::FibonacciGenerator(const uint64_t start) : index_(start)
+{
+	auto [current, next] = fibonacci_pair(start);
+	current_ = std::move(current);
+	next_ = std::move(next);
+}
+
+void FibonacciGenerator::next()
+{
+	current_ += next_;
+	std::swap(current_, next_);
+	++index_;
+}
 
 void fibonacci_main()
 {
 	std::string input;
-	n1 = 0;
-	n2 = 1;
 	std::cout << "Enter a how many positions to find Fibonacci sequence for: ";
 	std::cin >> input;
 	const unsigned long n = std::stoul(input);
@@ -17,22 +84,6 @@ void fibonacci_main()
 	{
 		throw std::invalid_argument("n must be greater than or equal to 1");
 	}
-	if (n == 1)
-		std::cout << n1 << " ";
-	if (n >= 2)
-		std::cout << n1 << " " << n2 << " ";
-	if (n > 2)
-		fibonacci(0, n - 2);
-}
-
-void fibonacci(unsigned long count, unsigned long limit)
-{
-	if (count < limit)
-	{
-		n3 = n1 + n2;
-		n1 = n2;
-		n2 = n3;
-		std::cout << n3 << " ";
-		fibonacci(count + 1, limit);
-	}
+	for (FibonacciGenerator generator; generator.index() < n; generator.next())
+		std::cout << generator.current() << " ";
 }
\ No newline at end of file
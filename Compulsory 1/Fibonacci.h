@@ -1,5 +1,53 @@
 #pragma once
 
+#include <array>
+#include <cstdint>
+#include <utility>
+
+#include "BigInt.h"
+
+// F(0) to F(93), every Fibonacci number that fits in 64 bits
+inline constexpr auto fibonacci_table = []
+{
+	std::array<uint64_t, 94> table{};
+	table[1] = 1;
+	for (size_t i = 2; i < table.size(); ++i)
+		table[i] = table[i - 1] + table[i - 2];
+	return table;
+}();
+
+#ifdef __SIZEOF_INT128__
+// F(0) to F(186), every Fibonacci number that fits in 128 bits
+inline constexpr auto fibonacci_table_128 = []
+{
+	std::array<unsigned __int128, 187> table{};
+	table[1] = 1;
+	for (size_t i = 2; i < table.size(); ++i)
+		table[i] = table[i - 1] + table[i - 2];
+	return table;
+}();
+#endif
+
 void fibonacci_main();
 
-void fibonacci(unsigned long count, unsigned long limit);
\ No newline at end of file
+// F(n) with F(0) = 0 and F(1) = 1, a table lookup for the values that fit in a machine word
+BigInt fibonacci(uint64_t n);
+
+// F(n) and F(n + 1)
+std::pair<BigInt, BigInt> fibonacci_pair(uint64_t n);
+
+// Steps through the sequence one term at a time, each step is a single addition
+class FibonacciGenerator
+{
+public:
+	explicit FibonacciGenerator(uint64_t start = 0);
+
+	const BigInt& current() const { return current_; }
+	uint64_t index() const { return index_; }
+	void next();
+
+private:
+	uint64_t index_;
+	BigInt current_;
+	BigInt next_;
+};
\ No newline at end of file
@@ -0,0 +1,619 @@
+#include "Modular.h"
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cmath>
+#include <numeric>
+#include <stdexcept>
+#include <utility>
+
+#include "Ntt.h"
+
+namespace modular
+{
+	namespace
+	{
+		// Arithmetic for an even modulus, the same interface as Montgomery without the form conversion
+		class Plain
+		{
+		public:
+			explicit Plain(const uint64_t modulus) : m_(modulus) {}
+
+			uint64_t to(const uint64_t x) const { return x % m_; }
+			uint64_t from(const uint64_t x) const { return x; }
+			uint64_t one() const { return 1 % m_; }
+
+			uint64_t multiply(const uint64_t a, const uint64_t b) const
+			{
+#ifdef __SIZEOF_INT128__
+				return static_cast<uint64_t>(static_cast<unsigned __int128>(a) * b % m_);
+#else
+				uint64_t low, remainder;
+				const uint64_t high = multiply_wide(a, b, low);
+				_udiv128(high, low, m_, &remainder);
+				return remainder;
+#endif
+			}
+
+			uint64_t add(const uint64_t a, const uint64_t b) const
+			{
+				const uint64_t sum = a + b;
+				return sum >= m_ || sum < a ? sum - m_ : sum;
+			}
+
+			uint64_t subtract(const uint64_t a, const uint64_t b) const
+			{
+				return a >= b ? a - b : a - b + m_;
+			}
+
+		private:
+			uint64_t m_;
+		};
+
+		template <class Arithmetic>
+		uint64_t fibonacci_doubling(const uint64_t n, const Arithmetic& arith)
+		{
+			// a = F(k), b = F(k + 1), F(2k) = F(k) * (2F(k + 1) - F(k)), F(2k + 1) = F(k)^2 + F(k + 1)^2
+			uint64_t a = arith.to(0), b = arith.one();
+			for (int bit = std::bit_width(n) - 1; bit >= 0; --bit)
+			{
+				const uint64_t c = arith.multiply(a, arith.subtract(arith.add(b, b), a));
+				const uint64_t d = arith.add(arith.multiply(a, a), arith.multiply(b, b));
+				if (n >> bit & 1)
+				{
+					a = d;
+					b = arith.add(c, d);
+				}
+				else
+				{
+					a = c;
+					b = d;
+				}
+			}
+			return arith.from(a);
+		}
+
+		// start * lo * (lo + 1) * ... * hi with start and the result in the form of arith
+		template <class Arithmetic>
+		uint64_t running_product(const uint64_t lo, const uint64_t hi, uint64_t start, const Arithmetic& arith)
+		{
+			for (uint64_t i = lo; i <= hi && i != 0; ++i)
+				start = arith.multiply(start, arith.to(i));
+			return start;
+		}
+
+		uint64_t isqrt(const uint64_t n)
+		{
+			uint64_t r = static_cast<uint64_t>(std::sqrt(static_cast<double>(n)));
+			while (r > 0 && (r > UINT32_MAX || r * r > n))
+				--r;
+			while (r + 1 <= UINT32_MAX && (r + 1) * (r + 1) <= n)
+				++r;
+			return r;
+		}
+
+		// NTT primes for convolutions modulo an arbitrary 64-bit modulus, with 2^23 or more dividing p - 1
+		// for every one of them, which covers every transform length ntt::max_length allows
+		constexpr std::array<uint32_t, 6> convolution_primes = { 2113929217, 2013265921, 1811939329, 1711276033, 1107296257, 998244353 };
+
+		// Convolutions modulo mont.modulus() of values in Montgomery form, with the result in Montgomery form
+		// too. They are done exactly modulo as many NTT primes as the largest coefficient needs, then Garner's
+		// algorithm brings each coefficient back modulo the 64-bit modulus
+		class Convolver
+		{
+		public:
+			// For coefficients that are sums of at most terms products
+			Convolver(const Montgomery& mont, const size_t terms) : mont_(mont)
+			{
+				// Every coefficient is below terms * (m - 1)^2, and each prime adds at least 29 bits
+				const uint64_t m = mont.modulus();
+				const int bits = 2 * std::bit_width(m - 1) + std::bit_width(terms) + 1;
+				count_ = std::min(convolution_primes.size(), static_cast<size_t>((bits + 28) / 29));
+
+				// Garner: x = c0 + c1 q0 + c2 q0 q1 + ..., weights_[k][j] = q0 ... q(j-1) mod qk and
+				// inverses_[k] = (q0 ... q(k-1))^-1 mod qk
+				for (size_t k = 0; k < count_; ++k)
+				{
+					uint64_t product = 1;
+					for (size_t j = 0; j < k; ++j)
+					{
+						weights_[k][j] = product;
+						product = product * convolution_primes[j] % convolution_primes[k];
+					}
+					inverses_[k] = ntt::pow_mod(static_cast<uint32_t>(product), convolution_primes[k] - 2, convolution_primes[k]);
+				}
+				// prefix_[k] = q0 ... q(k-1) mod m, multiplying by it through Montgomery also removes the
+				// extra 2^64 the product of two Montgomery forms carries
+				prefix_[0] = 1 % m;
+				for (size_t k = 1; k < count_; ++k)
+					prefix_[k] = mont.from(mont.multiply(mont.to(prefix_[k - 1]), mont.to(convolution_primes[k - 1])));
+			}
+
+			// The transforms of a zero padded to length, one per prime
+			std::vector<std::vector<uint32_t>> transform(const std::vector<uint64_t>& a, const size_t length) const
+			{
+				std::vector<std::vector<uint32_t>> transforms(count_);
+				for (size_t k = 0; k < count_; ++k)
+					transforms[k] = ntt::forward(residues(a, convolution_primes[k]), length, convolution_primes[k]);
+				return transforms;
+			}
+
+			// Coefficients first to first + count - 1 of the cyclic convolution of b with the value whose
+			// transforms are fa. They match the linear convolution when no product wraps around onto them
+			std::vector<uint64_t> convolve(const std::vector<std::vector<uint32_t>>& fa, const std::vector<uint64_t>& b, const size_t first, const size_t count) const
+			{
+				std::vector<std::vector<uint32_t>> products(count_);
+				for (size_t k = 0; k < count_; ++k)
+					products[k] = ntt::convolve_transformed(residues(b, convolution_primes[k]), fa[k], first + count, convolution_primes[k]);
+
+				const uint64_t m = mont_.modulus();
+				std::vector<uint64_t> result(count);
+				std::array<uint64_t, convolution_primes.size()> digits{};
+				for (size_t i = 0; i < count; ++i)
+				{
+					uint64_t x = 0;
+					for (size_t k = 0; k < count_; ++k)
+					{
+						// The value of c0 + c1 q0 + ... + c(k-1) q0 ... q(k-2) modulo qk, every product is below 2^62
+						const uint64_t q = convolution_primes[k];
+						uint64_t value = 0;
+						for (size_t j = 0; j < k; ++j)
+							value = (value + digits[j] * weights_[k][j]) % q;
+						digits[k] = (products[k][first + i] + q - value) * inverses_[k] % q;
+						x = mont_.add(x, mont_.multiply(digits[k] % m, prefix_[k]));
+					}
+					result[i] = x;
+				}
+				return result;
+			}
+
+		private:
+			const Montgomery& mont_;
+			size_t count_;
+			std::array<std::array<uint64_t, convolution_primes.size()>, convolution_primes.size()> weights_{};
+			std::array<uint64_t, convolution_primes.size()> inverses_{};
+			std::array<uint64_t, convolution_primes.size()> prefix_{};
+
+			static std::vector<uint32_t> residues(const std::vector<uint64_t>& a, const uint32_t q)
+			{
+				std::vector<uint32_t> result(a.size());
+				for (size_t i = 0; i < a.size(); ++i)
+					result[i] = static_cast<uint32_t>(a[i] % q);
+				return result;
+			}
+		};
+
+		// Samples of one polynomial modulo a prime, used by the sqrt(n) factorial
+		class SampleShifter
+		{
+		public:
+			SampleShifter(const Montgomery& mont, const size_t degree) : mont_(mont), inverse_factorials_(degree + 1)
+			{
+				uint64_t factorial = mont.one();
+				for (size_t i = 1; i <= degree; ++i)
+					factorial = mont.multiply(factorial, mont.to(i));
+				inverse_factorials_[degree] = mont.inverse(factorial);
+				for (size_t i = degree; i > 0; --i)
+					inverse_factorials_[i - 1] = mont.multiply(inverse_factorials_[i], mont.to(i));
+			}
+
+			// The transform length shift needs for up to count values of a polynomial of degree d
+			static size_t length(const size_t d, const size_t count) { return std::bit_ceil(d + count); }
+
+			// Takes f(0), ..., f(d) of a polynomial of degree d for the shifts that follow, which return at most
+			// count values. The Lagrange weights are transformed once here and shared by all of them
+			void load(const std::vector<uint64_t>& samples, const size_t count)
+			{
+				d_ = samples.size() - 1;
+				convolver_.emplace(mont_, d_ + 1);
+
+				// f(shift + k) = prod_j (shift + k - j) * sum_i f(i) / (i! (d - i)! (-1)^(d - i) (shift + k - i))
+				std::vector<uint64_t> weights(d_ + 1);
+				for (size_t i = 0; i <= d_; ++i)
+				{
+					const uint64_t w = mont_.multiply(samples[i], mont_.multiply(inverse_factorials_[i], inverse_factorials_[d_ - i]));
+					weights[i] = (d_ - i) % 2 == 0 ? w : mont_.subtract(0, w);
+				}
+				weights_ = convolver_->transform(weights, length(d_, count));
+			}
+
+			// f(shift), ..., f(shift + count - 1) of the loaded polynomial by Lagrange interpolation.
+			// shift - d + j must not be 0 modulo the prime for j in 0..d + count - 1
+			std::vector<uint64_t> shift(const uint64_t shift, const size_t count) const
+			{
+				const size_t d = d_;
+				const uint64_t m = mont_.modulus();
+
+				// values[j] = shift - d + j, inverses[j] = 1 / values[j] from one inversion of the product
+				const uint64_t first = shift >= d % m ? shift - d % m : shift + (m - d % m);
+				std::vector<uint64_t> values(d + count), inverses(d + count);
+				uint64_t running = mont_.one();
+				for (size_t j = 0; j < d + count; ++j)
+				{
+					values[j] = mont_.to(first + j >= m || first + j < first ? first + j - m : first + j);
+					inverses[j] = running;
+					running = mont_.multiply(running, values[j]);
+				}
+				running = mont_.inverse(running);
+				for (size_t j = d + count; j-- > 0;)
+				{
+					inverses[j] = mont_.multiply(inverses[j], running);
+					running = mont_.multiply(running, values[j]);
+				}
+
+				// Only the coefficients d..d + count - 1 are needed, the cyclic convolution of length
+				// d + count or more wraps nothing onto them
+				const auto sums = convolver_->convolve(weights_, inverses, d, count);
+				std::vector<uint64_t> result(count);
+				uint64_t window = mont_.one();
+				for (size_t j = 0; j <= d; ++j)
+					window = mont_.multiply(window, values[j]);
+				for (size_t k = 0; k < count; ++k)
+				{
+					if (k > 0)
+						window = mont_.multiply(mont_.multiply(window, values[k + d]), inverses[k - 1]);
+					result[k] = mont_.multiply(window, sums[k]);
+				}
+				return result;
+			}
+
+		private:
+			const Montgomery& mont_;
+			std::vector<uint64_t> inverse_factorials_;
+			size_t d_ = 0;
+			std::optional<Convolver> convolver_;
+			std::vector<std::vector<uint32_t>> weights_;
+		};
+
+		// Whether the sample shifting can find k! modulo a prime. The last doubling loads floor(sqrt(k) / 2) + 1
+		// samples and asks for about twice as many values, which has to fit one transform
+		bool fits_transform(const uint64_t k)
+		{
+			const uint64_t d = isqrt(k) / 2;
+			return SampleShifter::length(d, 2 * d + 1) <= ntt::max_length;
+		}
+
+		// n is odd and composite. Floyd's cycle finding on x^2 + c, with 64 differences multiplied together per gcd
+		uint64_t pollard_rho(const uint64_t n)
+		{
+			const Montgomery mont(n);
+			for (uint64_t c = 1;; ++c)
+			{
+				const uint64_t cm = mont.to(c);
+				const auto step = [&mont, cm](const uint64_t x) { return mont.add(mont.multiply(x, x), cm); };
+				uint64_t x = mont.to(2), y = x, divisor = 1;
+				while (divisor == 1)
+				{
+					const uint64_t saved_x = x, saved_y = y;
+					uint64_t product = mont.one();
+					for (int i = 0; i < 64; ++i)
+					{
+						x = step(x);
+						y = step(step(y));
+						product = mont.multiply(product, x > y ? x - y : y - x);
+					}
+					divisor = std::gcd(product, n);
+					if (divisor == n)
+					{
+						// The batch went past a factor, it is found again one difference at a time
+						x = saved_x;
+						y = saved_y;
+						do
+						{
+							x = step(x);
+							y = step(step(y));
+							divisor = std::gcd(x > y ? x - y : y - x, n);
+						} while (divisor == 1);
+					}
+				}
+				if (divisor != n)
+					return divisor;
+			}
+		}
+
+		// The prime factors of n with their exponents, in increasing order
+		std::vector<std::pair<uint64_t, int>> factorize(uint64_t n)
+		{
+			std::vector<uint64_t> primes;
+			for (uint64_t p = 2; p < 64; ++p)
+			{
+				for (; n % p == 0; n /= p)
+					primes.push_back(p);
+			}
+			std::vector<uint64_t> pending = { n };
+			while (!pending.empty())
+			{
+				const uint64_t x = pending.back();
+				pending.pop_back();
+				if (x == 1)
+					continue;
+				if (is_prime(x))
+				{
+					primes.push_back(x);
+					continue;
+				}
+				const uint64_t divisor = pollard_rho(x);
+				pending.push_back(divisor);
+				pending.push_back(x / divisor);
+			}
+			std::sort(primes.begin(), primes.end());
+
+			std::vector<std::pair<uint64_t, int>> factors;
+			for (const auto p : primes)
+			{
+				if (!factors.empty() && factors.back().first == p)
+					++factors.back().second;
+				else
+					factors.emplace_back(p, 1);
+			}
+			return factors;
+		}
+
+		// The smallest n with p^e dividing n!, by Legendre's formula it is the e-th multiple of p counted
+		// with the power of p in each
+		uint64_t first_factorial_multiple(const uint64_t p, const int e)
+		{
+			if (e == 1)
+				return p;
+			// e >= 2 means p < 2^32, so n stays below e * p without overflowing
+			uint64_t n = 0;
+			for (int count = 0; count < e;)
+			{
+				n += p;
+				for (uint64_t x = n; x % p == 0; x /= p)
+					++count;
+			}
+			return n;
+		}
+
+		// The longest running product a composite modulus is given, a few seconds on one core
+		constexpr uint64_t max_running_product = uint64_t{1} << 30;
+
+		// Below this the running product is faster than the polynomial machinery
+		constexpr uint64_t sqrt_factorial_threshold = uint64_t{1} << 16;
+	}
+
+	Montgomery::Montgomery(const uint64_t modulus) : m_(modulus), inverse_(modulus)
+	{
+		if (modulus % 2 == 0)
+			throw std::invalid_argument("Montgomery arithmetic needs an odd modulus");
+		// Every Newton step doubles the correct low bits, m is its own inverse mod 8
+		for (int i = 0; i < 5; ++i)
+			inverse_ *= 2 - modulus * inverse_;
+		one_ = (0 - modulus) % modulus;
+		r2_ = one_;
+		for (int i = 0; i < 64; ++i)
+			r2_ = add(r2_, r2_);
+	}
+
+	uint64_t Montgomery::pow(uint64_t base, uint64_t exponent) const
+	{
+		uint64_t result = one_;
+		while (exponent > 0)
+		{
+			if (exponent & 1)
+				result = multiply(result, base);
+			base = multiply(base, base);
+			exponent >>= 1;
+		}
+		return result;
+	}
+
+	bool is_prime(const uint64_t n)
+	{
+		if (n < 2)
+			return false;
+		for (const uint64_t small : { 2, 3, 5, 7, 11, 13, 17, 19, 23, 29, 31, 37 })
+		{
+			if (n % small == 0)
+				return n == small;
+		}
+		const Montgomery mont(n);
+		const int shift = std::countr_zero(n - 1);
+		const uint64_t odd = (n - 1) >> shift;
+		const uint64_t minus_one = mont.to(n - 1);
+		// These seven bases are enough for every n below 2^64
+		for (const uint64_t base : { 2, 325, 9375, 28178, 450775, 9780504, 1795265022 })
+		{
+			if (base % n == 0)
+				continue;
+			uint64_t x = mont.pow(mont.to(base), odd);
+			if (x == mont.one() || x == minus_one)
+				continue;
+			bool composite = true;
+			for (int i = 1; i < shift && composite; ++i)
+			{
+				x = mont.multiply(x, x);
+				composite = x != minus_one;
+			}
+			if (composite)
+				return false;
+		}
+		return true;
+	}
+
+	ModularContext::ModularContext(const uint64_t modulus) : modulus_(modulus), prime_(is_prime(modulus)), period_(0), zero_from_(modulus)
+	{
+		if (modulus == 0)
+			throw std::invalid_argument("The modulus must be at least 1");
+		if (modulus % 2 == 1)
+			montgomery_.emplace(modulus);
+		if (!prime_)
+		{
+			// m divides n! once every prime power of m does
+			zero_from_ = 0;
+			for (const auto& [p, e] : factorize(modulus))
+				zero_from_ = std::max(zero_from_, first_factorial_multiple(p, e));
+		}
+		if (prime_)
+		{
+			// The Pisano period of a prime p divides p - 1 when p = +-1 mod 5 and 2(p + 1) when p = +-2 mod 5
+			if (modulus == 2)
+				period_ = 3;
+			else if (modulus == 5)
+				period_ = 20;
+			else if (modulus % 5 == 1 || modulus % 5 == 4)
+				period_ = modulus - 1;
+			else if (modulus < UINT64_MAX / 2)
+				period_ = 2 * (modulus + 1);
+		}
+	}
+
+	uint64_t ModularContext::product(const uint64_t lo, const uint64_t hi, const uint64_t start) const
+	{
+		if (montgomery_)
+			return montgomery_->from(running_product(lo, hi, montgomery_->to(start), *montgomery_));
+		return running_product(lo, hi, start % modulus_, Plain(modulus_));
+	}
+
+	bool ModularContext::factorial_in_range(const uint64_t n) const
+	{
+		if (n >= zero_from_)
+			return true;
+		if (!prime_)
+			return n <= max_running_product;
+		const uint64_t k = n > modulus_ / 2 ? modulus_ - 1 - n : n;
+		return k < sqrt_factorial_threshold || fits_transform(k);
+	}
+
+	uint64_t ModularContext::factorial(const uint64_t n) const
+	{
+		if (n >= zero_from_)
+			return 0;
+		if (!factorial_in_range(n))
+			throw std::out_of_range("n is too large for a factorial modulo this modulus");
+		if (!prime_)
+			return product(2, n, 1);
+		if (n > modulus_ / 2)
+		{
+			// Wilson: (p - 1)! = -1 and (p - 1)! = n! * (-1)^k * k! with k = p - 1 - n
+			const Montgomery& mont = *montgomery_;
+			const uint64_t k = modulus_ - 1 - n;
+			const uint64_t inverse = mont.inverse(mont.to(factorial_prime(k)));
+			return mont.from(k % 2 == 1 ? inverse : mont.subtract(0, inverse));
+		}
+		return factorial_prime(n);
+	}
+
+	uint64_t ModularContext::factorial_prime(const uint64_t n) const
+	{
+		if (modulus_ == 2 || n < sqrt_factorial_threshold)
+			return product(2, n, 1);
+
+		// With g_d(x) = (vx + 1)(vx + 2)...(vx + d) and v = floor(sqrt(n)), g_v(0) g_v(1) ... g_v(v - 1) is
+		// (v^2)!. The samples g_d(0..d) are doubled to g_2d(0..2d) through g_2d(x) = g_d(x) g_d(x + d / v),
+		// with the shifted samples found by Lagrange interpolation. n < p / 2 here, which keeps every
+		// interpolation point away from the samples
+		const Montgomery& mont = *montgomery_;
+		const uint64_t v = isqrt(n);
+		const uint64_t vm = mont.to(v);
+		const uint64_t inverse_v = mont.inverse(vm);
+		SampleShifter shifter(mont, static_cast<size_t>(v));
+
+		std::vector<uint64_t> g = { mont.one(), mont.add(vm, mont.one()) };
+		uint64_t d = 1;
+		for (int bit = std::bit_width(v) - 2; bit >= 0; --bit)
+		{
+			// g_d(d + 1..2d) extends the samples to 0..2d, and g_d(d / v..d / v + 2d) are the second factors
+			const uint64_t offset = mont.from(mont.multiply(mont.to(d), inverse_v));
+			shifter.load(g, 2 * d + 1);
+			const auto upper = shifter.shift(d + 1, d);
+			const auto shifted = shifter.shift(offset, 2 * d + 1);
+			g.insert(g.end(), upper.begin(), upper.end());
+			for (size_t i = 0; i < g.size(); ++i)
+				g[i] = mont.multiply(g[i], shifted[i]);
+			d *= 2;
+
+			if (v >> bit & 1)
+			{
+				// g_(d + 1)(x) = g_d(x) (vx + d + 1), plus the new sample g_(d + 1)(d + 1)
+				uint64_t x = mont.to(d + 1);
+				for (auto& sample : g)
+				{
+					sample = mont.multiply(sample, x);
+					x = mont.add(x, vm);
+				}
+				g.push_back(mont.to(running_product(v * (d + 1) + 1, v * (d + 1) + d + 1, 1, Plain(modulus_))));
+				++d;
+			}
+		}
+
+		uint64_t result = mont.one();
+		for (uint64_t i = 0; i < v; ++i)
+			result = mont.multiply(result, g[i]);
+		return running_product(v * v + 1, n, mont.from(result), Plain(modulus_));
+	}
+
+	uint64_t ModularContext::fibonacci(uint64_t n) const
+	{
+		if (modulus_ == 1)
+			return 0;
+		if (period_ != 0)
+			n %= period_;
+		if (montgomery_)
+			return fibonacci_doubling(n, *montgomery_);
+		return fibonacci_doubling(n, Plain(modulus_));
+	}
+
+	std::vector<uint64_t> ModularContext::factorials(const std::span<const uint64_t> ns) const
+	{
+		// For a prime the queries above p / 2 turn into their Wilson counterpart first
+		const auto reduced = [this](const uint64_t n) { return prime_ && n < modulus_ && n > modulus_ / 2 ? modulus_ - 1 - n : n; };
+
+		std::vector<size_t> order(ns.size());
+		std::iota(order.begin(), order.end(), size_t{0});
+		std::sort(order.begin(), order.end(), [&](const size_t a, const size_t b) { return reduced(ns[a]) < reduced(ns[b]); });
+
+		for (const auto n : ns)
+		{
+			if (!factorial_in_range(n))
+				throw std::out_of_range("n is too large for a factorial modulo this modulus");
+		}
+
+		std::vector<uint64_t> results(ns.size());
+		uint64_t last = 0, value = 1 % modulus_;
+		for (const size_t index : order)
+		{
+			const uint64_t n = ns[index];
+			if (n >= zero_from_)
+			{
+				results[index] = 0;
+				continue;
+			}
+			const uint64_t k = reduced(n);
+			// Extend the previous product when the gap is cheaper than starting over
+			const uint64_t restart = prime_ && k >= sqrt_factorial_threshold ? 64 * isqrt(k) * std::bit_width(k) : k;
+			value = k - last <= restart ? product(last + 1, k, value) : factorial_prime(k);
+			last = k;
+			if (k == n)
+				results[index] = value;
+			else
+			{
+				const Montgomery& mont = *montgomery_;
+				const uint64_t inverse = mont.inverse(mont.to(value));
+				results[index] = mont.from(k % 2 == 1 ? inverse : mont.subtract(0, inverse));
+			}
+		}
+		return results;
+	}
+
+	std::vector<uint64_t> ModularContext::fibonaccis(const std::span<const uint64_t> ns) const
+	{
+		std::vector<uint64_t> results;
+		results.reserve(ns.size());
+		for (const auto n : ns)
+			results.push_back(fibonacci(n));
+		return results;
+	}
+
+	uint64_t factorial_mod(const uint64_t n, const uint64_t modulus)
+	{
+		return ModularContext(modulus).factorial(n);
+	}
+
+	uint64_t fibonacci_mod(const uint64_t n, const uint64_t modulus)
+	{
+		return ModularContext(modulus).fibonacci(n);
+	}
+}
\ No newline at end of file
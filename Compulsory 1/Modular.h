@@ -0,0 +1,123 @@
+#pragma once
+
+#include <cstdint>
+#include <optional>
+#include <span>
+#include <vector>
+
+#if defined(_MSC_VER) && !defined(__clang__)
+#include <intrin.h>
+#endif
+
+namespace modular
+{
+	// The high 64 bits of a * b, the low 64 bits are written to low
+	inline uint64_t multiply_wide(const uint64_t a, const uint64_t b, uint64_t& low)
+	{
+#if defined(_MSC_VER) && !defined(__clang__)
+		uint64_t high;
+		low = _umul128(a, b, &high);
+		return high;
+#else
+		const unsigned __int128 product = static_cast<unsigned __int128>(a) * b;
+		low = static_cast<uint64_t>(product);
+		return static_cast<uint64_t>(product >> 64);
+#endif
+	}
+
+	// Arithmetic modulo an odd 64-bit modulus with the values kept in Montgomery form x * 2^64 mod m,
+	// so a multiplication needs no division
+	class Montgomery
+	{
+	public:
+		explicit Montgomery(uint64_t modulus);
+
+		uint64_t modulus() const { return m_; }
+		uint64_t to(const uint64_t x) const { return multiply(x % m_, r2_); }
+		uint64_t from(const uint64_t x) const { return reduce(0, x); }
+		uint64_t one() const { return one_; }
+
+		uint64_t multiply(const uint64_t a, const uint64_t b) const
+		{
+			uint64_t low;
+			const uint64_t high = multiply_wide(a, b, low);
+			return reduce(high, low);
+		}
+
+		uint64_t add(const uint64_t a, const uint64_t b) const
+		{
+			const uint64_t sum = a + b;
+			return sum >= m_ || sum < a ? sum - m_ : sum;
+		}
+
+		uint64_t subtract(const uint64_t a, const uint64_t b) const
+		{
+			return a >= b ? a - b : a - b + m_;
+		}
+
+		uint64_t pow(uint64_t base, uint64_t exponent) const;
+
+		// Only valid for a prime modulus
+		uint64_t inverse(const uint64_t x) const { return pow(x, m_ - 2); }
+
+	private:
+		uint64_t m_;
+		uint64_t inverse_; // m^-1 mod 2^64
+		uint64_t r2_; // 2^128 mod m
+		uint64_t one_; // 2^64 mod m
+
+		// (high * 2^64 + low) * 2^-64 mod m, high must be below m
+		uint64_t reduce(const uint64_t high, const uint64_t low) const
+		{
+			uint64_t ignored;
+			const uint64_t correction = multiply_wide(low * inverse_, m_, ignored);
+			return high >= correction ? high - correction : high - correction + m_;
+		}
+	};
+
+	// Deterministic Miller-Rabin for every 64-bit n
+	bool is_prime(uint64_t n);
+
+	// Answers factorial and Fibonacci queries modulo one modulus. The Montgomery constants and the
+	// primality test are done once, so batches of queries share them
+	class ModularContext
+	{
+	public:
+		explicit ModularContext(uint64_t modulus);
+
+		uint64_t modulus() const { return modulus_; }
+		bool modulus_is_prime() const { return prime_; }
+
+		// n! mod m. For a prime modulus this takes O(sqrt(n) log n) through Wilson's theorem and
+		// shifting polynomial sample points. For any other modulus n! is 0 from the first n whose
+		// factorial m divides, found by factoring m, and below that it is a running product in O(n).
+		// Throws std::out_of_range when factorial_in_range(n) is false
+		uint64_t factorial(uint64_t n) const;
+
+		// False when n! mod m needs more than this class does: for a prime a transform longer than
+		// ntt::max_length, which is n and p - 1 - n both above about 3 * 10^13, otherwise a running
+		// product longer than 2^30
+		bool factorial_in_range(uint64_t n) const;
+
+		// F(n) mod m by fast doubling, for a prime modulus n is first reduced by a multiple of the Pisano period
+		uint64_t fibonacci(uint64_t n) const;
+
+		// The same as calling factorial on every n, but the queries are sorted so close ones extend the previous
+		// product. Throws std::out_of_range before doing any work if one n is not in range
+		std::vector<uint64_t> factorials(std::span<const uint64_t> ns) const;
+		std::vector<uint64_t> fibonaccis(std::span<const uint64_t> ns) const;
+
+	private:
+		uint64_t modulus_;
+		bool prime_;
+		uint64_t period_; // A multiple of the Pisano period, 0 when unknown
+		uint64_t zero_from_; // The smallest n with m dividing n!
+		std::optional<Montgomery> montgomery_; // Only for an odd modulus
+
+		uint64_t product(uint64_t lo, uint64_t hi, uint64_t start) const;
+		uint64_t factorial_prime(uint64_t n) const;
+	};
+
+	uint64_t factorial_mod(uint64_t n, uint64_t modulus);
+	uint64_t fibonacci_mod(uint64_t n, uint64_t modulus);
+}
\ No newline at end of file
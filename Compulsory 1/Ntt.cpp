@@ -0,0 +1,217 @@
+#include "Ntt.h"
+
+#include <algorithm>
+#include <bit>
+#include <utility>
+
+namespace ntt
+{
+	uint32_t pow_mod(uint32_t base, uint64_t exponent, const uint32_t mod)
+	{
+		uint64_t result = 1;
+		uint64_t b = base % mod;
+		while (exponent > 0)
+		{
+			if (exponent & 1)
+				result = result * b % mod;
+			b = b * b % mod;
+			exponent >>= 1;
+		}
+		return static_cast<uint32_t>(result);
+	}
+
+	uint32_t primitive_root(const uint32_t mod)
+	{
+		// g is a generator when g^((mod - 1) / q) != 1 for every prime factor q of mod - 1
+		std::vector<uint32_t> factors = { 2 };
+		uint32_t rest = (mod - 1) >> std::countr_zero(mod - 1);
+		for (uint32_t q = 3; q * q <= rest; q += 2)
+		{
+			if (rest % q != 0)
+				continue;
+			factors.push_back(q);
+			while (rest % q == 0)
+				rest /= q;
+		}
+		if (rest > 1)
+			factors.push_back(rest);
+		for (uint32_t g = 2;; ++g)
+		{
+			bool generator = true;
+			for (const auto q : factors)
+				generator = generator && pow_mod(g, (mod - 1) / q, mod) != 1;
+			if (generator)
+				return g;
+		}
+	}
+
+	namespace
+	{
+		// Montgomery multiplication with R = 2^32, replaces the 64-bit division of a % mod by two multiplications
+		struct Montgomery
+		{
+			uint32_t mod;
+			uint32_t inverse; // -mod^-1 mod 2^32
+			uint32_t r2; // 2^64 mod mod
+
+			explicit Montgomery(const uint32_t mod) : mod(mod), inverse(mod)
+			{
+				// Every Newton step doubles the correct low bits, mod is its own inverse mod 8
+				for (int i = 0; i < 4; ++i)
+					inverse *= 2 - mod * inverse;
+				inverse = 0 - inverse;
+				const uint64_t r = (uint64_t{1} << 32) % mod;
+				r2 = static_cast<uint32_t>(r * r % mod);
+			}
+
+			// t * 2^-32 mod mod, t must be below mod * 2^32
+			uint32_t reduce(const uint64_t t) const
+			{
+				const uint32_t m = static_cast<uint32_t>(t) * inverse;
+				const uint32_t u = static_cast<uint32_t>((t + static_cast<uint64_t>(m) * mod) >> 32);
+				return u >= mod ? u - mod : u;
+			}
+
+			uint32_t to_montgomery(const uint32_t x) const
+			{
+				return reduce(static_cast<uint64_t>(x) * r2);
+			}
+
+			// a * b mod mod when b is in Montgomery form
+			uint32_t multiply(const uint32_t a, const uint32_t b) const
+			{
+				return reduce(static_cast<uint64_t>(a) * b);
+			}
+		};
+
+		// 16384 values with their twiddle factors fit in a 128 KB cache
+		constexpr size_t cache_block = size_t{1} << 14;
+	}
+
+	void transform(std::vector<uint32_t>& a, const bool invert, const uint32_t mod)
+	{
+		const size_t n = a.size();
+		const Montgomery mont(mod);
+		// roots[length / 2 + k] = w^k for the root of unity w of order length, so every level reads its twiddle
+		// factors from one contiguous run. They are kept in Montgomery form so multiplying by them gives a
+		// plain residue, and each shorter level takes every other root of the level above it
+		std::vector<uint32_t> roots(std::max<size_t>(n, 2));
+		if (n >= 2)
+		{
+			uint32_t w = pow_mod(primitive_root(mod), (mod - 1) / n, mod);
+			if (invert)
+				w = pow_mod(w, mod - 2, mod);
+			const uint32_t wm = mont.to_montgomery(w);
+			uint32_t* top = roots.data() + n / 2;
+			top[0] = mont.to_montgomery(1);
+			for (size_t k = 1; k < n / 2; ++k)
+				top[k] = mont.multiply(top[k - 1], wm);
+			for (size_t half = n / 4; half >= 1; half >>= 1)
+			{
+				for (size_t k = 0; k < half; ++k)
+					roots[half + k] = roots[2 * half + 2 * k];
+			}
+		}
+
+		// The forward transform is decimation in frequency and leaves the values in bit-reversed order,
+		// the inverse is decimation in time and takes them in that order. A convolution only multiplies
+		// pointwise in between, so the bit reversal permutation is never needed
+		const auto forward_level = [&roots, mont, mod](uint32_t* values, const size_t size, const size_t length)
+		{
+			const size_t half = length / 2;
+			const uint32_t* twiddles = roots.data() + half;
+			for (size_t i = 0; i < size; i += length)
+			{
+				for (size_t k = 0; k < half; ++k)
+				{
+					const uint32_t u = values[i + k];
+					const uint32_t v = values[i + k + half];
+					values[i + k] = u + v >= mod ? u + v - mod : u + v;
+					values[i + k + half] = mont.multiply(u >= v ? u - v : u + mod - v, twiddles[k]);
+				}
+			}
+		};
+		const auto inverse_level = [&roots, mont, mod](uint32_t* values, const size_t size, const size_t length)
+		{
+			const size_t half = length / 2;
+			const uint32_t* twiddles = roots.data() + half;
+			for (size_t i = 0; i < size; i += length)
+			{
+				for (size_t k = 0; k < half; ++k)
+				{
+					const uint32_t u = values[i + k];
+					const uint32_t v = mont.multiply(values[i + k + half], twiddles[k]);
+					values[i + k] = u + v >= mod ? u + v - mod : u + v;
+					values[i + k + half] = u >= v ? u - v : u + mod - v;
+				}
+			}
+		};
+
+		// Levels longer than a block go over the whole array, the shorter ones only mix values inside one
+		// block, so each block does all of them while it is in cache instead of one pass over memory per level
+		const size_t block = std::min(n, cache_block);
+		if (!invert)
+		{
+			for (size_t length = n; length > block; length >>= 1)
+				forward_level(a.data(), n, length);
+			for (size_t start = 0; start < n; start += block)
+			{
+				for (size_t length = block; length >= 2; length >>= 1)
+					forward_level(a.data() + start, block, length);
+			}
+			return;
+		}
+
+		for (size_t start = 0; start < n; start += block)
+		{
+			for (size_t length = 2; length <= block; length <<= 1)
+				inverse_level(a.data() + start, block, length);
+		}
+		for (size_t length = block * 2; length <= n; length <<= 1)
+			inverse_level(a.data(), n, length);
+		const uint32_t inverse = mont.to_montgomery(pow_mod(static_cast<uint32_t>(n % mod), mod - 2, mod));
+		for (auto& x : a)
+			x = mont.multiply(x, inverse);
+	}
+
+	namespace
+	{
+		// The inverse transform of the pointwise product of two forward transforms, cut to size values
+		std::vector<uint32_t> pointwise_inverse(std::vector<uint32_t> fa, const std::vector<uint32_t>& fb, const size_t size, const uint32_t mod)
+		{
+			const Montgomery mont(mod);
+			for (size_t i = 0; i < fa.size(); ++i)
+				fa[i] = mont.multiply(fa[i], mont.to_montgomery(fb[i]));
+			transform(fa, true, mod);
+			fa.resize(size);
+			return fa;
+		}
+	}
+
+	std::vector<uint32_t> forward(const std::vector<uint32_t>& a, const size_t n, const uint32_t mod)
+	{
+		std::vector<uint32_t> fa(n);
+		for (size_t i = 0; i < a.size(); ++i)
+			fa[i] = a[i] % mod;
+		transform(fa, false, mod);
+		return fa;
+	}
+
+	std::vector<uint32_t> convolve_transformed(const std::vector<uint32_t>& a, const std::vector<uint32_t>& fb, const size_t size, const uint32_t mod)
+	{
+		return pointwise_inverse(forward(a, fb.size(), mod), fb, size, mod);
+	}
+
+	std::vector<uint32_t> convolve(const std::vector<uint32_t>& a, const std::vector<uint32_t>& b, const uint32_t mod)
+	{
+		if (a.empty() || b.empty())
+			return {};
+		const size_t size = a.size() + b.size() - 1;
+		const size_t n = std::bit_ceil(size);
+		std::vector<uint32_t> fa = forward(a, n, mod);
+		// A square only needs one forward transform
+		if (&a == &b)
+			return pointwise_inverse(fa, fa, size, mod);
+		return pointwise_inverse(std::move(fa), forward(b, n, mod), size, mod);
+	}
+}
@@ -0,0 +1,34 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace ntt
+{
+	// Any prime of the form c * 2^k + 1 below 2^31 works, the transform length can be at most 2^k
+	constexpr uint32_t prime1 = 998244353; // 119 * 2^23 + 1
+	constexpr uint32_t prime2 = 167772161; // 5 * 2^25 + 1
+	constexpr uint32_t prime3 = 754974721; // 45 * 2^24 + 1
+	constexpr size_t max_length = size_t{1} << 23;
+
+	uint32_t pow_mod(uint32_t base, uint64_t exponent, uint32_t mod);
+
+	// The smallest generator of the multiplicative group modulo the prime mod
+	uint32_t primitive_root(uint32_t mod);
+
+	// In-place number theoretic transform of a power of two length, the values must be below mod.
+	// The forward transform leaves the values in bit-reversed order and the inverse expects them so
+	void transform(std::vector<uint32_t>& a, bool invert, uint32_t mod);
+
+	// The forward transform of a zero padded to length n, a power of two at least a.size()
+	std::vector<uint32_t> forward(const std::vector<uint32_t>& a, size_t n, uint32_t mod);
+
+	// The linear convolution of a and a value whose forward transform is fb, cut to size values. The full
+	// convolution has to fit in fb.size() values, so a value that many convolutions share is transformed once
+	std::vector<uint32_t> convolve_transformed(const std::vector<uint32_t>& a, const std::vector<uint32_t>& fb, size_t size, uint32_t mod);
+
+	// The linear convolution of a and b modulo mod, a.size() + b.size() - 1 values. Passing the same
+	// vector twice squares it with one forward transform less
+	std::vector<uint32_t> convolve(const std::vector<uint32_t>& a, const std::vector<uint32_t>& b, uint32_t mod);
+}
@@ -1,12 +1,19 @@
 #include <algorithm>
+#include <array>
+#include <cctype>
+#include <cmath>
 #include <iostream>
 #include <chrono>
+#include <memory>
 #include <random>
+#include <string>
 
 #include "BubbleSort.h"
 #include "Console.h"
 #include "IntroSort.h"
+#include "Logger.h"
 #include "MergeSort.h"
+#include "Memory.h"
 
 auto rnd = std::default_random_engine{ std::random_device{}() };
 
@@ -23,20 +30,29 @@ std::vector<int> generate_random_vector(const int size)
 }
 
 /**
- * \brief Measure the time of the sorting
+ * \brief Measure the time and heap usage of the sorting
  * \param sort The sorting function to use
  * \param size The array size to use
  * \param alg The name of the algorithm used
- * \return The time it took to sort the list
+ * \param log The queue to report progress to, nullptr to run quietly
+ * \return List of size 5 with the time it took to sort the list, the allocations, the bytes allocated, the peak heap use and the growth of the resident memory of the sort
  */
-double time(void(sort)(std::vector<int>& arr), const int size, const std::string& alg)
+std::vector<double> time(void(sort)(std::vector<int>& arr), const int size, const std::string& alg, logger::Queue* log)
 {
-    std::cout << "Creating random array of size: " << size << std::endl;
+    if (log != nullptr)
+        log->push(logger::Record::Creating, alg, size);
     auto vec = generate_random_vector(size);
-    std::cout << "Sorting array of size: " << size << " with algorithm " << alg << std::endl;
+    if (log != nullptr)
+        log->push(logger::Record::Sorting, alg, size);
+    memory::begin_measure();
+    const auto& stats = memory::allocation_stats();
+    const long long live = stats.live;
+    const auto resident = memory::resident_bytes();
     const std::chrono::high_resolution_clock::time_point t1 = std::chrono::high_resolution_clock::now();
     sort(vec);
-    return static_cast<double>(std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::high_resolution_clock::now() - t1).count());
+    const auto elapsed = static_cast<double>(std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::high_resolution_clock::now() - t1).count());
+    const auto grown = std::max(memory::resident_bytes(), resident) - resident;
+    return { elapsed, static_cast<double>(stats.allocations), static_cast<double>(stats.bytes), static_cast<double>(stats.peak - live), static_cast<double>(grown) };
 }
 
 /**
@@ -61,47 +77,188 @@ std::vector<double> time_min_max_sd(std::vector<double> times)
 }
 
 /**
- * \brief Measure the time of the sorting with 10 iterations
+ * \brief Measure the time and memory use of the sorting with 10 iterations
  * \param sort The sorting function to use
  * \param size The array size to use
  * \param alg The name of the algorithm used
- * \return List of size 3 with values in order as min,max,sd
+ * \param log The queue to report progress to, nullptr to run quietly
+ * \return List of size 7 with values in order as min,max,sd,allocations,bytes,peak heap,RSS growth (the memory values are the largest of the iterations)
  */
-std::vector<double> time_multiple(void(sort)(std::vector<int>& arr), const int size, const std::string& alg)
+std::vector<double> time_multiple(void(sort)(std::vector<int>& arr), const int size, const std::string& alg, logger::Queue* log)
 {
     std::vector<double> times;
+    std::vector<double> usage = { 0, 0, 0, 0 };
     times.reserve(10);
     for (int i = 0; i < 10; i++)
     {
-        times.push_back(time(sort, size, alg));
+        const auto run = time(sort, size, alg, log);
+        times.push_back(run[0]);
+        for (int k = 0; k < 4; k++)
+        {
+            if (run[k + 1] > usage[k])
+                usage[k] = run[k + 1];
+        }
     }
-    return time_min_max_sd(times);
+    auto ret = time_min_max_sd(times);
+    ret.insert(ret.end(), usage.begin(), usage.end());
+    return ret;
 }
 
-int main()
+/**
+ * \brief Fits time = c * n^k with least squares in log-log space
+ * \param sizes The array sizes
+ * \param times The times for each size
+ * \return The exponent k
+ */
+double fit_exponent(const std::vector<double>& sizes, const std::vector<double>& times)
 {
+    double sumX = 0, sumY = 0, sumXX = 0, sumXY = 0;
+    const auto count = static_cast<double>(sizes.size());
+    for (size_t i = 0; i < sizes.size(); ++i)
+    {
+        const double x = std::log(sizes[i]);
+        const double y = std::log(times[i]);
+        sumX += x;
+        sumY += y;
+        sumXX += x * x;
+        sumXY += x * y;
+    }
+    const double denominator = count * sumXX - sumX * sumX;
+    if (count < 2 || denominator == 0)
+        return 0;
+    return (count * sumXY - sumX * sumY) / denominator;
+}
+
+/**
+ * \brief Times a sort over sizes that grow by a factor of √2 and estimates how it scales
+ *
+ * Starts at 16 and stops when the working set, the array plus the peak heap use of the sort, passes max_bytes or a
+ * single sort takes longer than budget. Each size runs at least 3 times and until it has taken 20ms in total, the
+ * fastest run is kept. A line marks where the working set outgrows each cache level, and at the end a power law is
+ * fitted to the times of at least 1µs and compared with the exponent the algorithm should have.
+ * \param sort The sorting function to use
+ * \param alg The name of the algorithm used
+ * \param expected The exponent the algorithm should scale with on random input, n log n counts as 1
+ * \param max_bytes The largest working set to try
+ * \param budget The longest a single sort may take in microseconds before the sizes stop growing
+ * \param caches The L1, L2 and L3 cache sizes
+ */
+void sweep(void(sort)(std::vector<int>& arr), const std::string& alg, const double expected, const std::size_t max_bytes, const double budget, const std::array<std::size_t, 3>& caches)
+{
+    std::cout << std::endl << console::Modifier(console::FG_BRIGHT_BLUE) << alg << console::Modifier(console::FG_DEFAULT) << std::endl;
+    console::TimeFormat::print_sweep_header();
+
+    std::vector<double> sizes;
+    std::vector<double> times;
+    int cache_level = 0;
+    for (double next = 16; ; next *= std::sqrt(2.0))
+    {
+        const int size = static_cast<int>(next);
+        if (size * sizeof(int) > max_bytes)
+            break;
+        double best = -1, total = 0;
+        long long peak = 0;
+        for (int run = 0; run < 3 || total < 20000; ++run)
+        {
+            auto vec = generate_random_vector(size);
+            memory::begin_measure();
+            const auto& stats = memory::allocation_stats();
+            const long long live = stats.live;
+            const std::chrono::high_resolution_clock::time_point t1 = std::chrono::high_resolution_clock::now();
+            sort(vec);
+            const double elapsed = std::chrono::duration<double, std::micro>(std::chrono::high_resolution_clock::now() - t1).count();
+            peak = std::max(peak, stats.peak - live);
+            total += elapsed;
+            if (best < 0 || elapsed < best)
+                best = elapsed;
+            if (elapsed > budget)
+                break;
+        }
+
+        const double working_set = static_cast<double>(size * sizeof(int) + peak);
+        if (working_set > static_cast<double>(max_bytes))
+            break;
+        while (cache_level < 3 && (caches[cache_level] == 0 || working_set > static_cast<double>(caches[cache_level])))
+        {
+            if (caches[cache_level] != 0)
+                console::TimeFormat::print_cache_marker(cache_level + 1, static_cast<double>(caches[cache_level]));
+            cache_level++;
+        }
+        console::TimeFormat::print_sweep_row(size, working_set, best);
+
+        if (best >= 1)
+        {
+            sizes.push_back(size);
+            times.push_back(best);
+        }
+        if (best > budget)
+            break;
+    }
+
+    const double exponent = fit_exponent(sizes, times);
+    const bool suspicious = exponent > expected + 0.3;
+    std::cout << "Fitted exponent: " << console::Modifier(suspicious ? console::FG_RED : console::FG_GREEN) << exponent << console::Modifier(console::FG_DEFAULT) << " (expected about " << expected << ")";
+    if (suspicious)
+        std::cout << console::Modifier(console::FG_RED) << " scales worse than it should" << console::Modifier(console::FG_DEFAULT);
+    std::cout << std::endl;
+}
+
+int main(int argc, char* argv[])
+{
+#ifdef _WIN32
     SetConsoleOutputCP(CP_UTF8);
+#endif
     auto _ = setvbuf(stdout, nullptr, _IOFBF, 1024);
 
-    const auto bubbleSortTimes10 = time_multiple(BubbleSort::sort, 10, "BubbleSort");
-    const auto introSortTimes10 = time_multiple(IntroSort::sort, 10, "IntroSort");
-    const auto mergeSortTimes10 = time_multiple(MergeSort::sort, 10, "MergeSort");
+    // --quiet leaves out the progress messages, --sweep [max MiB] runs every algorithm over growing sizes instead of the fixed ones
+    bool quiet = false;
+    std::size_t sweep_bytes = 0;
+    for (int i = 1; i < argc; ++i)
+    {
+        if (std::string(argv[i]) == "--quiet")
+            quiet = true;
+        if (std::string(argv[i]) == "--sweep")
+            sweep_bytes = (i + 1 < argc && std::isdigit(static_cast<unsigned char>(argv[i + 1][0])) ? std::stoull(argv[++i]) : 256) * 1024 * 1024;
+    }
+    if (sweep_bytes != 0)
+    {
+        const auto caches = memory::cache_sizes();
+        sweep(BubbleSort::sort, "Bubble Sort", 2, sweep_bytes, 2000000, caches);
+        sweep(MergeSort::sort, "Merge Sort", 1, sweep_bytes, 2000000, caches);
+        sweep(IntroSort::sort, "Intro Sort", 1, sweep_bytes, 2000000, caches);
+        return 0;
+    }
+    // The progress messages are printed by a background thread so the timed code never writes to the console
+    auto progress = quiet ? nullptr : std::make_unique<logger::Logger>();
+    logger::Queue* log = progress ? &progress->queue() : nullptr;
+
+    const auto bubbleSortTimes10 = time_multiple(BubbleSort::sort, 10, "BubbleSort", log);
+    const auto introSortTimes10 = time_multiple(IntroSort::sort, 10, "IntroSort", log);
+    const auto mergeSortTimes10 = time_multiple(MergeSort::sort, 10, "MergeSort", log);
 
-    const auto bubbleSortTimes100 = time_multiple(BubbleSort::sort, 100, "BubbleSort");
-    const auto introSortTimes100 = time_multiple(IntroSort::sort, 100, "IntroSort");
-    const auto mergeSortTimes100 = time_multiple(MergeSort::sort, 100, "MergeSort");
+    const auto bubbleSortTimes100 = time_multiple(BubbleSort::sort, 100, "BubbleSort", log);
+    const auto introSortTimes100 = time_multiple(IntroSort::sort, 100, "IntroSort", log);
+    const auto mergeSortTimes100 = time_multiple(MergeSort::sort, 100, "MergeSort", log);
 
-    const auto bubbleSortTimes1000 = time_multiple(BubbleSort::sort, 1000, "BubbleSort");
-    const auto introSortTimes1000 = time_multiple(IntroSort::sort, 1000, "IntroSort");
-    const auto mergeSortTimes1000 = time_multiple(MergeSort::sort, 1000, "MergeSort");
+    const auto bubbleSortTimes1000 = time_multiple(BubbleSort::sort, 1000, "BubbleSort", log);
+    const auto introSortTimes1000 = time_multiple(IntroSort::sort, 1000, "IntroSort", log);
+    const auto mergeSortTimes1000 = time_multiple(MergeSort::sort, 1000, "MergeSort", log);
 
-    const auto bubbleSortTimes10000 = time_multiple(BubbleSort::sort, 10000, "BubbleSort");
-    const auto introSortTimes10000 = time_multiple(IntroSort::sort, 10000, "IntroSort");
-    const auto mergeSortTimes10000 = time_multiple(MergeSort::sort, 10000, "MergeSort");
+    const auto bubbleSortTimes10000 = time_multiple(BubbleSort::sort, 10000, "BubbleSort", log);
+    const auto introSortTimes10000 = time_multiple(IntroSort::sort, 10000, "IntroSort", log);
+    const auto mergeSortTimes10000 = time_multiple(MergeSort::sort, 10000, "MergeSort", log);
+
+    // Prints the rest of the progress messages before the table
+    progress.reset();
 
     console::TimeFormat::print_time("Bubble Sort 10000", bubbleSortTimes10000, true);
     console::TimeFormat::print_time("Merge Sort 10000", mergeSortTimes10000, true);
     console::TimeFormat::print_time("Intro Sort 10000", introSortTimes10000, true);
+    // The memory columns do not grow with the size like the times do, so every row has to be measured
+    for (const auto& times : { bubbleSortTimes10, bubbleSortTimes100, bubbleSortTimes1000, mergeSortTimes10, mergeSortTimes100, mergeSortTimes1000, introSortTimes10, introSortTimes100, introSortTimes1000 })
+    {
+        console::TimeFormat::print_time("", times, true);
+    }
 
     for (int i = 0; i < 50; ++i)
     {
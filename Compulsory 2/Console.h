@@ -1,9 +1,13 @@
 #pragma once
+#include <algorithm>
+#include <cmath>
 #include <iomanip>
 #include <iostream>
 #include <string>
 #include <vector>
+#ifdef _WIN32
 #include <Windows.h>
+#endif
 
 namespace console
 {
@@ -58,7 +62,7 @@ namespace console
     class Modifier
     {
         Code code;
-        byte r, g, b;
+        unsigned char r, g, b;
         bool bit24;
 
     public:
@@ -88,7 +92,7 @@ namespace console
          * @param bit24 Whether the color is a 24-bit color or 8 bit value
          * @return The modifier to use with: cout << modifier << "text";
          */
-        Modifier(const Code p_code, const byte table_or_r_color, const byte g = 0, const byte b = 0, const bool bit24 = false) : code(p_code), r(table_or_r_color), g(g), b(b), bit24(bit24) {}
+        Modifier(const Code p_code, const unsigned char table_or_r_color, const unsigned char g = 0, const unsigned char b = 0, const bool bit24 = false) : code(p_code), r(table_or_r_color), g(g), b(b), bit24(bit24) {}
         friend std::ostream&
             operator<<(std::ostream& os, const Modifier& mod)
         {
@@ -113,6 +117,11 @@ namespace console
     int minLen = 0;
     int maxLen = 0;
     int sdLen = 0;
+    // These start at the length of their header, which is often longer than the values
+    int allocLen = 6;  // Allocs
+    int bytesLen = 5;  // Bytes
+    int peakLen = 9;   // Peak heap
+    int rssLen = 10;   // RSS growth
 
     class TimeFormat
     {
@@ -144,11 +153,35 @@ namespace console
             return format_number(static_cast<long long>(time / 1000)) + add + "ms";
         }
 
+        static std::string format_bytes(double bytes)
+        {
+            const char* units[] = { "B", "KiB", "MiB", "GiB" };
+            int unit = 0;
+            while (bytes >= 1024 && unit < 3)
+            {
+                bytes /= 1024;
+                unit++;
+            }
+            auto str = std::to_string(bytes);
+            str = str.substr(0, str.find('.') + (unit == 0 ? 0 : 3));
+            return str + " " + units[unit];
+        }
+
+        static void print_line(int len)
+        {
+            constexpr auto c = u8"─";
+            std::cout << u8"┼";
+            for (int i = 0; i < len + 2; ++i)
+            {
+                std::cout << c;
+            }
+        }
+
     public:
         /**
          * \brief Formats the time to ms and prints it as a part of the table
          * \param name The name for the table row
-         * \param time The times in min,max,sd
+         * \param time The times in min,max,sd followed by allocations,bytes,peak heap,RSS growth
          * \param dry If it should just set the size of the string length instead of printing it
          */
         static void print_time(std::string name, std::vector<double> time, bool dry = false)
@@ -156,6 +189,10 @@ namespace console
             const auto minStr = format_time(time[0]);
             const auto maxStr = format_time(time[1]);
             const auto sdStr = format_time(time[2]);
+            const auto allocStr = format_number(static_cast<long long>(time[3]));
+            const auto bytesStr = format_bytes(time[4]);
+            const auto peakStr = format_bytes(time[5]);
+            const auto rssStr = format_bytes(time[6]);
             if (!dry)
             {
                 print_element(name, nameLen);
@@ -165,14 +202,26 @@ namespace console
                 print_element(maxStr, maxLen, true, Modifier(FG_BRIGHT_ORANGE));
                 std::cout << u8" │ ";
                 print_element(sdStr, sdLen, true, Modifier(FG_BRIGHT_MAGENTA));
+                std::cout << u8" │ ";
+                print_element(allocStr, allocLen, true);
+                std::cout << u8" │ ";
+                print_element(bytesStr, bytesLen, true);
+                std::cout << u8" │ ";
+                print_element(peakStr, peakLen, true);
+                std::cout << u8" │ ";
+                print_element(rssStr, rssLen, true);
                 std::cout << std::endl;
             }
             else
             {
-                minLen = max(minLen, static_cast<int>(minStr.length()));
-                maxLen = max(maxLen, static_cast<int>(maxStr.length()));
-                sdLen = max(sdLen, static_cast<int>(sdStr.length()));
-                nameLen = max(nameLen, static_cast<int>(name.length()));
+                minLen = (std::max)(minLen, static_cast<int>(minStr.length()));
+                maxLen = (std::max)(maxLen, static_cast<int>(maxStr.length()));
+                sdLen = (std::max)(sdLen, static_cast<int>(sdStr.length()));
+                allocLen = (std::max)(allocLen, static_cast<int>(allocStr.length()));
+                bytesLen = (std::max)(bytesLen, static_cast<int>(bytesStr.length()));
+                peakLen = (std::max)(peakLen, static_cast<int>(peakStr.length()));
+                rssLen = (std::max)(rssLen, static_cast<int>(rssStr.length()));
+                nameLen = (std::max)(nameLen, static_cast<int>(name.length()));
             }
         }
 
@@ -188,9 +237,65 @@ namespace console
             print_element("Max", maxLen, true, Modifier(FG_DEFAULT));
             std::cout << u8" │ ";
             print_element("SD", sdLen, true, Modifier(FG_DEFAULT));
+            std::cout << u8" │ ";
+            print_element("Allocs", allocLen, true, Modifier(FG_DEFAULT));
+            std::cout << u8" │ ";
+            print_element("Bytes", bytesLen, true, Modifier(FG_DEFAULT));
+            std::cout << u8" │ ";
+            print_element("Peak heap", peakLen, true, Modifier(FG_DEFAULT));
+            std::cout << u8" │ ";
+            print_element("RSS growth", rssLen, true, Modifier(FG_DEFAULT));
+            std::cout << std::endl;
+        }
+
+        /**
+         * \brief Prints the header of a sweep table
+         */
+        static void print_sweep_header()
+        {
+            print_element("n", 14, true);
+            std::cout << u8" │ ";
+            print_element("Working set", 12, true);
+            std::cout << u8" │ ";
+            print_element("Time", 12, true);
+            std::cout << u8" │ ";
+            print_element("ns/n", 10, true);
+            std::cout << u8" │ ";
+            print_element("ns/(n log n)", 12, true);
             std::cout << std::endl;
         }
 
+        /**
+         * \brief Prints one size of a sweep table
+         * \param size The array size
+         * \param working_set The bytes the sort touched, the array and its peak heap use
+         * \param time The fastest time in microseconds
+         */
+        static void print_sweep_row(const int size, const double working_set, const double time)
+        {
+            const double per_element = time * 1000 / size;
+            print_element(format_number(size), 14, true);
+            std::cout << u8" │ ";
+            print_element(format_bytes(working_set), 12, true);
+            std::cout << u8" │ ";
+            print_element(format_time(time), 12, true, Modifier(FG_BRIGHT_CYAN));
+            std::cout << u8" │ ";
+            print_element(per_element, 10, true);
+            std::cout << u8" │ ";
+            print_element(per_element / std::log2(size), 12, true);
+            std::cout << std::endl;
+        }
+
+        /**
+         * \brief Prints the line that marks where the working set outgrows a cache level
+         * \param level The cache level, 1 to 3
+         * \param bytes The size of the cache
+         */
+        static void print_cache_marker(const int level, const double bytes)
+        {
+            std::cout << Modifier(FG_ORANGE) << "-- working set leaves L" << level << " (" << format_bytes(bytes) << ")" << Modifier(FG_DEFAULT) << std::endl;
+        }
+
         /**
          * \brief Prints the table separator
          */
@@ -216,6 +321,10 @@ namespace console
             {
                 std::cout << c;
             }
+            print_line(allocLen);
+            print_line(bytesLen);
+            print_line(peakLen);
+            print_line(rssLen);
             std::cout << std::endl;
         }
     };
@@ -60,7 +60,7 @@ void IntroSort::shift_down(std::vector<int>& arr, int left, int right)
     }
 }
 
-int IntroSort::leaf_search(std::vector<int> arr, int left, int right)
+int IntroSort::leaf_search(const std::vector<int>& arr, int left, int right)
 {
     int i = left;
     while (2 * i + 2 <= right)
@@ -50,7 +50,7 @@ class IntroSort : public SortBase<int>
      * \param right The right index
      * \return The index of the first leaf
      */
-    static int leaf_search(std::vector<int> arr, int left, int right);
+    static int leaf_search(const std::vector<int>& arr, int left, int right);
 
     /**
      * \brief Shifts the array down
@@ -0,0 +1,144 @@
+#pragma once
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <iostream>
+#include <string>
+#include <thread>
+
+namespace logger
+{
+    /**
+     * \brief A progress message, fixed size so the timed code only copies a few bytes
+     */
+    struct Record
+    {
+        enum Kind { Creating, Sorting } kind;
+        char alg[16];
+        int size;
+    };
+
+    /**
+     * \brief Lock-free single producer, single consumer ring buffer of records
+     *
+     * The producer never waits, if the buffer is full the record is dropped and counted instead.
+     */
+    class Queue
+    {
+        static constexpr size_t capacity = 1024;
+        std::array<Record, capacity> records_{};
+        alignas(64) std::atomic<size_t> head_{ 0 };
+        alignas(64) std::atomic<size_t> tail_{ 0 };
+        std::atomic<long long> dropped_{ 0 };
+
+    public:
+        /**
+         * \brief Adds a record to the queue, only call this from the producer thread
+         * \param kind What the record reports
+         * \param alg The name of the algorithm, cut to 15 characters
+         * \param size The array size
+         */
+        void push(const Record::Kind kind, const std::string& alg, const int size)
+        {
+            const size_t t = tail_.load(std::memory_order_relaxed);
+            if (t - head_.load(std::memory_order_acquire) == capacity)
+            {
+                dropped_.fetch_add(1, std::memory_order_relaxed);
+                return;
+            }
+            Record& record = records_[t % capacity];
+            record.kind = kind;
+            const size_t length = alg.size() < sizeof record.alg ? alg.size() : sizeof record.alg - 1;
+            std::memcpy(record.alg, alg.data(), length);
+            record.alg[length] = '\0';
+            record.size = size;
+            tail_.store(t + 1, std::memory_order_release);
+        }
+
+        /**
+         * \brief Takes the oldest record out of the queue, only call this from the consumer thread
+         * \param record Where the record is written to
+         * \return If there was a record
+         */
+        bool pop(Record& record)
+        {
+            const size_t h = head_.load(std::memory_order_relaxed);
+            if (h == tail_.load(std::memory_order_acquire))
+                return false;
+            record = records_[h % capacity];
+            head_.store(h + 1, std::memory_order_release);
+            return true;
+        }
+
+        long long dropped() const
+        {
+            return dropped_.load(std::memory_order_relaxed);
+        }
+    };
+
+    /**
+     * \brief Prints the records of a queue from a background thread
+     *
+     * The records are written without flushing, the output is only flushed when the queue is empty.
+     */
+    class Logger
+    {
+        Queue queue_;
+        std::atomic<bool> running_{ true };
+        std::thread worker_;
+
+        static void print(const Record& record)
+        {
+            if (record.kind == Record::Creating)
+                std::cout << "Creating random array of size: " << record.size << '\n';
+            else
+                std::cout << "Sorting array of size: " << record.size << " with algorithm " << record.alg << '\n';
+        }
+
+        void run()
+        {
+            Record record{};
+            while (true)
+            {
+                const bool stopping = !running_.load(std::memory_order_acquire);
+                bool printed = false;
+                while (queue_.pop(record))
+                {
+                    print(record);
+                    printed = true;
+                }
+                if (printed)
+                    continue;
+                std::cout.flush();
+                if (stopping)
+                    break;
+                std::this_thread::sleep_for(std::chrono::milliseconds(1));
+            }
+        }
+
+    public:
+        Logger() : worker_(&Logger::run, this)
+        {
+        }
+
+        /**
+         * \brief Prints whatever is left in the queue and stops the logger thread
+         */
+        ~Logger()
+        {
+            running_.store(false, std::memory_order_release);
+            worker_.join();
+            if (queue_.dropped() > 0)
+                std::cout << queue_.dropped() << " progress messages were dropped" << std::endl;
+        }
+
+        Logger(const Logger&) = delete;
+        Logger& operator=(const Logger&) = delete;
+
+        Queue& queue()
+        {
+            return queue_;
+        }
+    };
+}
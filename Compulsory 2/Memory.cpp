@@ -0,0 +1,107 @@
+#include "Memory.h"
+
+#include <cstdlib>
+#include <new>
+#include <vector>
+
+#ifdef _WIN32
+#include <Windows.h>
+#include <Psapi.h>
+#else
+#include <cstdio>
+#include <unistd.h>
+#endif
+
+namespace
+{
+    // Every block carries its size in front of it so delete knows how much is released.
+    // The header is as big as the strictest fundamental alignment so the block stays aligned.
+    constexpr std::size_t header_size = alignof(std::max_align_t);
+
+    thread_local memory::AllocationStats stats;
+}
+
+memory::AllocationStats& memory::allocation_stats()
+{
+    return stats;
+}
+
+void memory::begin_measure()
+{
+    stats.allocations = 0;
+    stats.bytes = 0;
+    stats.peak = stats.live;
+}
+
+std::size_t memory::resident_bytes()
+{
+#ifdef _WIN32
+    PROCESS_MEMORY_COUNTERS counters;
+    if (!GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters)))
+        return 0;
+    return counters.WorkingSetSize;
+#else
+    // The second field of statm is the resident size in pages
+    std::FILE* file = std::fopen("/proc/self/statm", "r");
+    if (file == nullptr)
+        return 0;
+    unsigned long size = 0, resident = 0;
+    const int read = std::fscanf(file, "%lu %lu", &size, &resident);
+    std::fclose(file);
+    return read == 2 ? static_cast<std::size_t>(resident) * static_cast<std::size_t>(sysconf(_SC_PAGESIZE)) : 0;
+#endif
+}
+
+std::array<std::size_t, 3> memory::cache_sizes()
+{
+    std::array<std::size_t, 3> sizes{};
+#ifdef _WIN32
+    DWORD length = 0;
+    GetLogicalProcessorInformation(nullptr, &length);
+    std::vector<SYSTEM_LOGICAL_PROCESSOR_INFORMATION> info(length / sizeof(SYSTEM_LOGICAL_PROCESSOR_INFORMATION));
+    if (info.empty() || !GetLogicalProcessorInformation(info.data(), &length))
+        return sizes;
+    for (const auto& entry : info)
+    {
+        if (entry.Relationship != RelationCache || entry.Cache.Type == CacheInstruction)
+            continue;
+        const int level = entry.Cache.Level;
+        if (level >= 1 && level <= 3 && entry.Cache.Size > sizes[level - 1])
+            sizes[level - 1] = entry.Cache.Size;
+    }
+#elif defined(_SC_LEVEL1_DCACHE_SIZE)
+    // sysconf answers -1 or 0 for a level it does not know
+    const long levels[] = { sysconf(_SC_LEVEL1_DCACHE_SIZE), sysconf(_SC_LEVEL2_CACHE_SIZE), sysconf(_SC_LEVEL3_CACHE_SIZE) };
+    for (int level = 0; level < 3; ++level)
+        sizes[level] = levels[level] > 0 ? static_cast<std::size_t>(levels[level]) : 0;
+#endif
+    return sizes;
+}
+
+void* operator new(const std::size_t size)
+{
+    auto* block = static_cast<unsigned char*>(std::malloc(size + header_size));
+    if (block == nullptr)
+        throw std::bad_alloc();
+    *reinterpret_cast<std::size_t*>(block) = size;
+    stats.allocations++;
+    stats.bytes += static_cast<long long>(size);
+    stats.live += static_cast<long long>(size);
+    if (stats.live > stats.peak)
+        stats.peak = stats.live;
+    return block + header_size;
+}
+
+void operator delete(void* pointer) noexcept
+{
+    if (pointer == nullptr)
+        return;
+    auto* block = static_cast<unsigned char*>(pointer) - header_size;
+    stats.live -= static_cast<long long>(*reinterpret_cast<std::size_t*>(block));
+    std::free(block);
+}
+
+void operator delete(void* pointer, std::size_t) noexcept
+{
+    operator delete(pointer);
+}
@@ -0,0 +1,46 @@
+#pragma once
+#include <array>
+#include <cstddef>
+
+namespace memory
+{
+    /**
+     * \brief Heap usage counted by the global operator new and delete of this program
+     */
+    struct AllocationStats
+    {
+        long long allocations = 0;
+        long long bytes = 0;
+        long long live = 0;
+        long long peak = 0;
+    };
+
+    /**
+     * \brief Gets the allocation counters of the calling thread
+     * \return The counters, allocations and bytes count up from the last call to begin_measure
+     */
+    AllocationStats& allocation_stats();
+
+    /**
+     * \brief Starts a new measurement on the calling thread
+     *
+     * Resets the allocation and byte counters and moves the peak down to what is live right now,
+     * so peak - live afterwards is the high-water mark of the measured code alone.
+     */
+    void begin_measure();
+
+    /**
+     * \brief Gets the resident memory of the whole process right now
+     *
+     * The process peak never goes down, so a single run is measured as the growth of this value
+     * from just before the run to the end of it instead.
+     * \return The current working set (RSS) in bytes, 0 if it is not available
+     */
+    std::size_t resident_bytes();
+
+    /**
+     * \brief Gets the sizes of the data caches
+     * \return The L1, L2 and L3 data cache sizes in bytes, 0 for a level that is not present or not reported
+     */
+    std::array<std::size_t, 3> cache_sizes();
+}
@@ -0,0 +1,290 @@
+#pragma once
+#include <algorithm>
+#include <atomic>
+#include <barrier>
+#include <bit>
+#include <cstdint>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "CsrGraph.h"
+
+/**
+ * \brief The result of a breadth first search, the amount of edges to every vertex and the vertex it was found from.
+ */
+class BreadthFirstTree
+{
+    std::vector<int> hops;
+    std::vector<int> parents;
+    int levels;
+    int bottom_up_levels;
+public:
+    /**
+     * \brief Creates a result from the arrays of a search.
+     * \param hops The amount of edges from the start to every vertex, -1 for a vertex that was not reached.
+     * \param parents The vertex every vertex was found from, -1 for the start and a vertex that was not reached.
+     * \param levels The amount of levels the search expanded.
+     * \param bottom_up_levels The amount of those levels that were expanded bottom up.
+     */
+    BreadthFirstTree(std::vector<int> hops, std::vector<int> parents, int levels, int bottom_up_levels);
+
+    /**
+     * \brief Gets the amount of edges on the shortest path to a vertex.
+     * \param vertex The index of the vertex.
+     * \return The amount of edges, -1 if the vertex was not reached.
+     */
+    [[nodiscard]] int get_hops(int vertex) const;
+
+    /**
+     * \brief Gets the vertex before a vertex on a shortest path.
+     * \param vertex The index of the vertex.
+     * \return The index of the previous vertex, -1 for the start or a vertex that was not reached.
+     */
+    [[nodiscard]] int get_parent(int vertex) const;
+
+    /**
+     * \brief Checks if the search reached a vertex.
+     * \param vertex The index of the vertex.
+     * \return True if there is a path to the vertex, false otherwise.
+     */
+    [[nodiscard]] bool is_reached(int vertex) const;
+
+    /**
+     * \brief Gets the amount of levels the search expanded.
+     * \return The amount of levels.
+     */
+    [[nodiscard]] int get_levels() const;
+
+    /**
+     * \brief Gets the amount of levels that were expanded bottom up.
+     * \return The amount of bottom up levels.
+     */
+    [[nodiscard]] int get_bottom_up_levels() const;
+
+    /**
+     * \brief Gets the amount of vertexes in the searched graph.
+     * \return The amount of vertexes in the searched graph.
+     */
+    [[nodiscard]] int size() const;
+};
+
+/**
+ * \brief Finds the fewest edges from a vertex to every vertex with a direction optimizing breadth first search, in parallel.
+ * A small frontier is expanded top down, every frontier vertex claims its unvisited neighbours. Once the edges of the
+ * frontier outnumber the edges into the unvisited vertexes by more than alpha, a level is cheaper bottom up, where
+ * every unvisited vertex looks for any parent in the frontier bitmap and stops at the first one. When the frontier
+ * shrinks below a beta'th of the graph the search goes back to top down.
+ * Top down levels split the frontier over the threads and claim vertexes with an atomic or on the visited bitmap,
+ * bottom up levels give every thread its own range of bitmap words so no atomics are needed.
+ * \tparam T The type of the value in the vertexes.
+ * \param graph The graph to search, weights are ignored.
+ * \param reversed The graph with every edge reversed, the same graph if every edge goes both ways.
+ * \param start The index of the starting vertex.
+ * \param thread_count The amount of threads to use, 0 for one per hardware thread.
+ * \return The hop distances and parents of every vertex.
+ */
+template <class T>
+BreadthFirstTree breadth_first_search(const CsrGraph<T>& graph, const CsrGraph<T>& reversed, const int start, int thread_count = 0)
+{
+    // The switching thresholds from Beamer, Asanovic and Patterson
+    constexpr auto alpha = 14;
+    constexpr auto beta = 24;
+    if (thread_count <= 0)
+        thread_count = std::max(1, static_cast<int>(std::thread::hardware_concurrency()));
+
+    const auto size = graph.size();
+    const auto words = (size + 63) / 64;
+    auto hops = std::vector<int>(size, -1);
+    auto parents = std::vector<int>(size, -1);
+    auto visited = std::vector<std::atomic<uint64_t>>(words);
+    auto frontier_bits = std::vector<uint64_t>(words, 0);
+    auto next_bits = std::vector<uint64_t>(words, 0);
+    auto frontier = std::vector<int>{ start };
+    hops[start] = 0;
+    visited[start / 64].store(uint64_t{ 1 } << start % 64, std::memory_order_relaxed);
+
+    struct alignas(64) Local
+    {
+        std::vector<int> next;
+        int found = 0;
+        long long out_edges = 0;
+        long long in_edges = 0;
+    };
+    auto locals = std::vector<Local>(thread_count);
+    auto unexplored_edges = static_cast<long long>(reversed.edge_count()) - reversed.get_degree(start);
+    auto frontier_size = 1;
+    auto level = 0;
+    auto bottom_up = false;
+    auto bottom_up_levels = 0;
+    auto done = false;
+
+    const auto next_level = [&]() noexcept
+    {
+        auto found = 0;
+        auto out_edges = 0LL;
+        for (const auto& local : locals)
+        {
+            found += local.found;
+            out_edges += local.out_edges;
+            unexplored_edges -= local.in_edges;
+        }
+        level++;
+        bottom_up_levels += bottom_up ? 1 : 0;
+        if (found == 0)
+        {
+            done = true;
+            return;
+        }
+
+        const auto was_bottom_up = bottom_up;
+        if (!bottom_up && out_edges > unexplored_edges / alpha)
+            bottom_up = true;
+        else if (bottom_up && found < frontier_size && found < size / beta)
+            bottom_up = false;
+        frontier_size = found;
+
+        // Convert the new frontier to the form the next level reads
+        if (bottom_up && was_bottom_up)
+            std::swap(frontier_bits, next_bits);
+        else if (bottom_up)
+        {
+            std::ranges::fill(frontier_bits, 0);
+            for (const auto& local : locals)
+            {
+                for (const auto vertex : local.next)
+                    frontier_bits[vertex / 64] |= uint64_t{ 1 } << vertex % 64;
+            }
+        }
+        else
+        {
+            frontier.clear();
+            if (was_bottom_up)
+            {
+                for (auto word = 0; word < words; word++)
+                {
+                    for (auto bits = next_bits[word]; bits != 0; bits &= bits - 1)
+                        frontier.push_back(word * 64 + std::countr_zero(bits));
+                }
+            }
+            for (const auto& local : locals)
+                frontier.insert(frontier.end(), local.next.begin(), local.next.end());
+        }
+        for (auto& local : locals)
+            local = Local();
+    };
+    auto barrier = std::barrier(thread_count, next_level);
+
+    const auto top_down = [&](Local& local, const int thread)
+    {
+        const auto first = frontier.size() * thread / thread_count;
+        const auto last = frontier.size() * (thread + 1) / thread_count;
+        for (auto i = first; i < last; i++)
+        {
+            const auto vertex = frontier[i];
+            for (const auto to : graph.get_targets(vertex))
+            {
+                auto& word = visited[to / 64];
+                const auto bit = uint64_t{ 1 } << to % 64;
+                // Reading first avoids the atomic write for the many neighbours that are already visited
+                if ((word.load(std::memory_order_relaxed) & bit) != 0 || (word.fetch_or(bit, std::memory_order_relaxed) & bit) != 0)
+                    continue;
+                hops[to] = level + 1;
+                parents[to] = vertex;
+                local.next.push_back(to);
+                local.found++;
+                local.out_edges += graph.get_degree(to);
+                local.in_edges += reversed.get_degree(to);
+            }
+        }
+    };
+
+    const auto bottom_up_step = [&](Local& local, const int thread)
+    {
+        const auto first = words * thread / thread_count;
+        const auto last = words * (thread + 1) / thread_count;
+        for (auto word = first; word < last; word++)
+        {
+            auto unvisited = ~visited[word].load(std::memory_order_relaxed);
+            if (word == words - 1 && size % 64 != 0)
+                unvisited &= (uint64_t{ 1 } << size % 64) - 1;
+            auto found = uint64_t{ 0 };
+            for (; unvisited != 0; unvisited &= unvisited - 1)
+            {
+                const auto vertex = word * 64 + std::countr_zero(unvisited);
+                for (const auto from : reversed.get_targets(vertex))
+                {
+                    if ((frontier_bits[from / 64] >> from % 64 & 1) == 0)
+                        continue;
+                    hops[vertex] = level + 1;
+                    parents[vertex] = from;
+                    found |= uint64_t{ 1 } << vertex % 64;
+                    local.found++;
+                    local.out_edges += graph.get_degree(vertex);
+                    local.in_edges += reversed.get_degree(vertex);
+                    break;
+                }
+            }
+            next_bits[word] = found;
+            visited[word].fetch_or(found, std::memory_order_relaxed);
+        }
+    };
+
+    const auto worker = [&](const int thread)
+    {
+        while (!done)
+        {
+            if (bottom_up)
+                bottom_up_step(locals[thread], thread);
+            else
+                top_down(locals[thread], thread);
+            barrier.arrive_and_wait();
+        }
+    };
+
+    {
+        auto threads = std::vector<std::jthread>();
+        for (auto thread = 1; thread < thread_count; thread++)
+            threads.emplace_back(worker, thread);
+        worker(0);
+    }
+    return BreadthFirstTree(std::move(hops), std::move(parents), level, bottom_up_levels);
+}
+
+inline BreadthFirstTree::BreadthFirstTree(std::vector<int> hops, std::vector<int> parents, int levels, int bottom_up_levels)
+{
+    this->hops = std::move(hops);
+    this->parents = std::move(parents);
+    this->levels = levels;
+    this->bottom_up_levels = bottom_up_levels;
+}
+
+inline int BreadthFirstTree::get_hops(int vertex) const
+{
+    return this->hops[vertex];
+}
+
+inline int BreadthFirstTree::get_parent(int vertex) const
+{
+    return this->parents[vertex];
+}
+
+inline bool BreadthFirstTree::is_reached(int vertex) const
+{
+    return this->hops[vertex] != -1;
+}
+
+inline int BreadthFirstTree::get_levels() const
+{
+    return this->levels;
+}
+
+inline int BreadthFirstTree::get_bottom_up_levels() const
+{
+    return this->bottom_up_levels;
+}
+
+inline int BreadthFirstTree::size() const
+{
+    return static_cast<int>(this->hops.size());
+}
@@ -1,88 +1,32 @@
 ﻿#include <algorithm>
 #include <chrono>
-#include <functional>
 #include <iostream>
-#include <map>
 #include <ostream>
-#include <queue>
+#include <random>
+#include <span>
+#include <sstream>
 #include <Windows.h>
 
+#include "ContractionHierarchy.h"
+#include "BreadthFirstSearch.h"
+#include "CsrGraph.h"
+#include "DeltaStepping.h"
 #include "Graph.h"
+#include "GridGraph.h"
+#include "Heuristics.h"
+#include "IndexedHeap.h"
+#include "JumpPointSearch.h"
+#include "Landmarks.h"
 #include "Node.h"
+#include "PathFinding.h"
 #include "PerlinNoise.h"
+#include "QueryEngine.h"
 
 const char8_t* line = u8"│ ";
 const char8_t* corner = u8"└─";
 const char8_t* tee = u8"├─";
 const char8_t* microseconds = u8" µs";
 
-class vector3d
-{
-    float x;
-    float y;
-    float z;
-
-public:
-    vector3d(float x, float y, float z) : x(x), y(y), z(z)
-    {
-
-    }
-
-    vector3d() : x(0), y(0), z(0)
-    {
-
-    }
-
-    [[nodiscard]] float length() const
-    {
-        return sqrtf(x * x + y * y + z * z);
-    }
-
-    [[nodiscard]] float distance(vector3d other) const
-    {
-        return sqrtf(powf(x - other.x, 2) + powf(y - other.y, 2) + powf(z - other.z, 2));
-    }
-
-    [[nodiscard]] bool connected(vector3d other) const
-    {
-        const float distance_x = abs(x - other.x);
-        const float distance_z = abs(z - other.z);
-        const float manhattan_distance = distance_x + distance_z;
-        return (distance_x < 2 && distance_x > 0 || (distance_z < 2 && distance_z > 0)) && manhattan_distance < 3;
-    }
-
-    [[nodiscard]] float heuristic(vector3d other) const
-    {
-        return distance(other);
-    }
-
-    void print(bool x = true, bool y = true, bool z = true) const
-    {
-        std::cout << "(";
-        bool printed = false;
-        if (x)
-        {
-            std::cout << this->x;
-            printed = true;
-        }
-        if (printed)
-        {
-            std::cout << ", ";
-            printed = false;
-        }
-        if (y)
-        {
-            std::cout << this->y;
-            printed = true;
-        }
-        if (printed)
-            std::cout << ", ";
-        if (z)
-            std::cout << this->z;
-        std::cout << ")";
-    }
-};
-
 #pragma region Print
 template <class T>
 void print_tree(Node<T> tree, const int i, const bool end = false)
@@ -127,6 +71,15 @@ void print_graph(Graph<T>& graph)
     }
     std::cout << "]" << std::endl;
 }
+void print_path(const GridGraph& grid, const std::span<int> path)
+{
+    std::cout << "Path: ";
+    for (auto it = path.begin(); it != path.end(); ++it)
+    {
+        std::cout << "(" << grid.get_x(*it) << ", " << grid.get_z(*it) << ")" << (it != path.end() - 1 ? " -> " : "");
+    }
+    std::cout << std::endl;
+}
 #pragma endregion functions
 
 #pragma region Path finding
@@ -224,170 +177,6 @@ std::vector<Vertex<T>*> fastest_path(Vertex<T>* graph, const T value, std::vecto
     return shortest;
 }
 
-template <class T>
-struct VertexTotalDistance
-{
-    Vertex<T>* vertex;
-    float distance;
-
-    bool operator>(const VertexTotalDistance& other) const
-    {
-        return distance > other.distance;
-    }
-
-    bool operator<(const VertexTotalDistance& other) const
-    {
-        return distance < other.distance;
-    }
-
-    bool operator==(const VertexTotalDistance& other) const
-    {
-        return vertex == other.vertex;
-    }
-
-    bool operator!=(const VertexTotalDistance& other) const
-    {
-        return vertex != other.vertex;
-    }
-};
-
-/**
- * \brief Finds the shortest path between two vertexes in a graph.
- * \param start The starting vertex.
- * \param goal The goal vertex.
- * \return A tuple with the goal vertex and the path to it.
- */
-std::tuple<VertexTotalDistance<int>, Node<VertexTotalDistance<int>>*> dijkstra_internal(Graph<int>* graph, Vertex<int>* start, Vertex<int>* goal)
-{
-    auto visited = std::vector<VertexTotalDistance<int>>();
-    auto process = std::priority_queue<VertexTotalDistance<int>, std::vector<VertexTotalDistance<int>>, std::greater<>>();
-    auto nodes = std::map<Vertex<int>*, Node<VertexTotalDistance<int>>*>();
-    const auto node = new Node<VertexTotalDistance<int>>({ start, 0 });
-    process.push(node->get_value());
-    visited.push_back(node->get_value());
-    nodes.insert({ start, node });
-    while (!process.empty())
-    {
-        const auto [vertex, distance] = process.top();
-        process.pop();
-        if (vertex == goal)
-        {
-            return { { vertex, distance }, node };
-        }
-        for (auto edges = vertex->get_edges(); auto edge : edges)
-        {
-            const auto to = edge->get_to();
-            const auto from = edge->get_from();
-            const auto computed_distance = edge->get_distance() + distance;
-            const auto vertex_distance = VertexTotalDistance{ to, computed_distance };
-            if (std::find_if(visited.begin(), visited.end(), [&vertex_distance](const VertexTotalDistance<int> v)->bool {return v == vertex_distance; }) != visited.end())
-                continue;
-            visited.push_back(vertex_distance);
-            process.push(vertex_distance);
-            const auto new_node = new Node<VertexTotalDistance<int>>({ to, computed_distance });
-            nodes[from]->add_child(new_node);
-            nodes.insert({ to, new_node });
-        }
-    }
-}
-
-std::tuple<VertexTotalDistance<vector3d>, Node<VertexTotalDistance<vector3d>>*> dijkstra_internal(Graph<vector3d>* graph, Vertex<vector3d>* start, Vertex<vector3d>* goal)
-{
-    auto visited = std::vector<VertexTotalDistance<vector3d>>();
-    auto process = std::priority_queue<VertexTotalDistance<vector3d>, std::vector<VertexTotalDistance<vector3d>>, std::greater<>>();
-    auto nodes = std::map<Vertex<vector3d>*, Node<VertexTotalDistance<vector3d>>*>();
-    const auto node = new Node<VertexTotalDistance<vector3d>>({ start, 0 });
-    process.push(node->get_value());
-    visited.push_back(node->get_value());
-    nodes.insert({ start, node });
-    while (!process.empty())
-    {
-        const auto [vertex, distance] = process.top();
-        process.pop();
-        if (vertex == goal)
-        {
-            return { { vertex, distance }, node };
-        }
-        for (auto vertexes = graph->get_vertices(); const auto to : vertexes)
-        {
-            if (!vertex->get_value().connected(to->get_value()))
-                continue;
-            const auto computed_distance = vertex->get_value().distance(to->get_value()) + distance;
-            const auto edges = vertex->get_edges();
-            if(std::ranges::find_if(edges.begin(), edges.end(), [&to](const Edge<vector3d>* e){return e->get_to() == to || e->get_from() == to;}) == edges.end())
-                vertex->add_edge(to, computed_distance);
-            const auto vertex_distance = VertexTotalDistance{ to, computed_distance };
-            if (std::ranges::find_if(visited, [&vertex_distance](const VertexTotalDistance<vector3d> v)->bool {return v == vertex_distance; }) != visited.end())
-                continue;
-            visited.push_back(vertex_distance);
-            process.push(vertex_distance);
-            const auto new_node = new Node<VertexTotalDistance<vector3d>>({ to, computed_distance });
-            nodes[vertex]->add_child(new_node);
-            nodes.insert({ to, new_node });
-        }
-    }
-}
-
-template <class T>
-std::vector<VertexTotalDistance<T>> dijkstra(Graph<T>* graph, Vertex<T>* start, Vertex<T>* goal)
-{
-    std::tuple<VertexTotalDistance<T>, Node<VertexTotalDistance<T>>*> tuple = dijkstra_internal(graph, start, goal);
-    auto [vertex, node] = tuple;
-    auto visited = std::vector<VertexTotalDistance<T>>();
-    auto path = fastest_path(*node, vertex, visited);
-    node->remove_all_children();
-    delete node;
-    return path;
-}
-
-std::tuple<VertexTotalDistance<vector3d>, Node<VertexTotalDistance<vector3d>>*> astar_internal(Graph<vector3d>* graph, Vertex<vector3d>* start, Vertex<vector3d>* goal)
-{
-    auto visited = std::vector<VertexTotalDistance<vector3d>>();
-    auto process = std::priority_queue<VertexTotalDistance<vector3d>, std::vector<VertexTotalDistance<vector3d>>, std::greater<>>();
-    auto nodes = std::map<Vertex<vector3d>*, Node<VertexTotalDistance<vector3d>>*>();
-    const auto node = new Node<VertexTotalDistance<vector3d>>({ start, 0 });
-    process.push(node->get_value());
-    visited.push_back(node->get_value());
-    nodes.insert({ start, node });
-    while (!process.empty())
-    {
-        const auto [vertex, distance] = process.top();
-        process.pop();
-        if (vertex == goal)
-        {
-            return { { vertex, distance }, node };
-        }
-        for (auto vertexes = graph->get_vertices(); const auto to : vertexes)
-        {
-            if (!vertex->get_value().connected(to->get_value()))
-                continue;
-            const auto heuristic = to->get_value().heuristic(goal->get_value());
-            const auto computed_distance = vertex->get_value().distance(to->get_value()) + heuristic;
-            const auto edges = vertex->get_edges();
-            if(std::ranges::find_if(edges.begin(), edges.end(), [&to](const Edge<vector3d>* e){return e->get_to() == to || e->get_from() == to;}) == edges.end())
-                vertex->add_edge(to, computed_distance);
-            const auto vertex_distance = VertexTotalDistance{ to, computed_distance };
-            if (std::ranges::find_if(visited, [&vertex_distance](const VertexTotalDistance<vector3d> v)->bool {return v == vertex_distance; }) != visited.end())
-                continue;
-            visited.push_back(vertex_distance);
-            process.push(vertex_distance);
-            const auto new_node = new Node<VertexTotalDistance<vector3d>>({ to, computed_distance });
-            nodes[vertex]->add_child(new_node);
-            nodes.insert({ to, new_node });
-        }
-    }
-}
-
-std::vector<VertexTotalDistance<vector3d>> astar(Graph<vector3d>* graph, Vertex<vector3d>* start, Vertex<vector3d>* goal)
-{
-    std::tuple<VertexTotalDistance<vector3d>, Node<VertexTotalDistance<vector3d>>*> tuple = astar_internal(graph, start, goal);
-    auto [vertex, node] = tuple;
-    auto visited = std::vector<VertexTotalDistance<vector3d>>();
-    auto path = fastest_path(*node, vertex, visited);
-    node->remove_all_children();
-    delete node;
-    return path;
-}
 #pragma endregion functions
 
 int main()
@@ -486,14 +275,27 @@ int main()
     std::cout << std::endl;
     std::cout << std::endl;
 
-    // Find the shortest path between two vertexes.
+    // Find the shortest path between two vertexes on a compressed snapshot of the graph.
+    const auto csr = CsrGraph(*graph);
 
-    const auto path2 = dijkstra(graph, vertex1, vertex4);
+    auto path_buffer = std::vector<int>(csr.size());
+    const auto path2 = dijkstra(csr, 1, 4).extract_path(4, path_buffer);
     std::cout << "Path: ";
 
     for (auto it = path2.begin(); it != path2.end(); ++it)
     {
-        std::cout << it->vertex->get_value() << (it != path2.end() - 1 ? " -> " : "");
+        std::cout << csr.get_value(*it) << (it != path2.end() - 1 ? " -> " : "");
+    }
+
+    std::cout << std::endl;
+
+    // Count the edges to every vertex, the edges of the graph go both ways so it is its own reverse.
+    const auto hops = breadth_first_search(csr, csr, 1);
+    std::cout << "Hops:";
+
+    for (auto i = 0; i < hops.size(); i++)
+    {
+        std::cout << " " << csr.get_value(i) << "=" << hops.get_hops(i);
     }
 
     std::cout << std::endl;
@@ -503,79 +305,204 @@ int main()
 
     constexpr siv::PerlinNoise::seed_type seed = 123456u;
     const siv::PerlinNoise perlin(seed);
-    const auto graph_3d = new Graph<vector3d>();
+    constexpr int width = 100;
+    constexpr int depth = 100;
+    auto heights = std::vector<float>(width * depth);
 
-    for (int x = 1; x <= 100; x++)
+    for (int x = 0; x < width; x++)
     {
-        for (int z = 1; z <= 100; z++)
+        for (int z = 0; z < depth; z++)
         {
-            auto value = static_cast<float>(perlin.octave2D_01(x * 0.03, z * 0.03, 4) * 10);
-            value = static_cast<float>(perlin.octave3D_01(x * 0.03, value, z * 0.03, 4) * 10);
-            graph_3d->add_vertex(new Vertex<vector3d>({ static_cast<float>(x), value, static_cast<float>(z) }));
+            auto value = static_cast<float>(perlin.octave2D_01((x + 1) * 0.03, (z + 1) * 0.03, 4) * 10);
+            value = static_cast<float>(perlin.octave3D_01((x + 1) * 0.03, value, (z + 1) * 0.03, 4) * 10);
+            heights[x * depth + z] = value;
         }
     }
 
-    const auto vertices_3d = graph_3d->get_vertices();
-
-    const auto vertex1_3d = vertices_3d[0];
-    const auto vertex2_3d = vertices_3d[vertices_3d.size() - 1];
+    const auto grid = GridGraph(width, depth, std::move(heights));
+    const auto start_3d = grid.get_index(0, 0);
+    const auto goal_3d = grid.get_index(width - 1, depth - 1);
+    auto path_buffer_3d = std::vector<int>(grid.size());
 
     auto start = std::chrono::high_resolution_clock::now();
-    const auto path3 = dijkstra(graph_3d, vertex1_3d, vertex2_3d);
+    const auto paths3 = dijkstra(grid, start_3d, goal_3d);
+    const auto path3 = paths3.extract_path(goal_3d, path_buffer_3d);
     auto end = std::chrono::high_resolution_clock::now();
     const auto dihkstra_time = std::chrono::duration_cast<std::chrono::microseconds>(end - start).count();
 
-    std::cout << "Path: ";
+    print_path(grid, path3);
 
-    for (auto it = path3.begin(); it != path3.end(); ++it)
-    {
-        it->vertex->get_value().print(true, false);
-        std::cout << (it != path3.end() - 1 ? " -> " : "");
-    }
+    std::cout << std::endl;
+    const int dijkstra_length = paths3.get_expanded();
+
+    start = std::chrono::high_resolution_clock::now();
+    const auto paths4 = astar(grid, start_3d, goal_3d, OctileHeuristic(grid, goal_3d));
+    const auto path4 = paths4.extract_path(goal_3d, path_buffer_3d);
+    end = std::chrono::high_resolution_clock::now();
+    const auto astar_time = std::chrono::duration_cast<std::chrono::microseconds>(end - start).count();
+
+    print_path(grid, path4);
 
     std::cout << std::endl;
+    const int astar_length = paths4.get_expanded();
+
+    std::cout << "Graph legnth: " << grid.size() << std::endl;
+    std::cout << "Dijkstra length: " << dijkstra_length << std::endl;
+    std::cout << "A* length: " << astar_length << std::endl;
+
+    std::cout << "Dijkstra time: " << dihkstra_time << reinterpret_cast<const char*>(microseconds) << std::endl;
+    std::cout << "A* time: " << astar_time << reinterpret_cast<const char*>(microseconds) << std::endl;
+
     std::cout << std::endl;
-    int dijkstra_length = 0;
 
-    for(const auto vertex_3d : vertices_3d)
-    {
-        if(!vertex_3d->is_empty())
-            dijkstra_length++;
-        for(const auto edge_3d : vertex_3d->get_edges())
-            vertex_3d->remove_edge(edge_3d);
-    }
+    // The terrain grid has the same distance both ways, so it is its own reverse graph
+    start = std::chrono::high_resolution_clock::now();
+    const auto paths5 = bidirectional_dijkstra(grid, grid, start_3d, goal_3d);
+    end = std::chrono::high_resolution_clock::now();
+    const auto bidirectional_dijkstra_time = std::chrono::duration_cast<std::chrono::microseconds>(end - start).count();
 
     start = std::chrono::high_resolution_clock::now();
-    const auto path4 = astar(graph_3d, vertex1_3d, vertex2_3d);
+    const auto paths6 = bidirectional_astar(grid, grid, start_3d, goal_3d, OctileHeuristic(grid, goal_3d), OctileHeuristic(grid, start_3d));
     end = std::chrono::high_resolution_clock::now();
-    const auto astar_time = std::chrono::duration_cast<std::chrono::microseconds>(end - start).count();
+    const auto bidirectional_astar_time = std::chrono::duration_cast<std::chrono::microseconds>(end - start).count();
 
-    std::cout << "Path: ";
+    std::cout << "Bidirectional distance: " << paths5.get_distance(goal_3d) << ", " << paths6.get_distance(goal_3d) << std::endl;
+    std::cout << "Bidirectional Dijkstra length: " << paths5.get_expanded() << std::endl;
+    std::cout << "Bidirectional A* length: " << paths6.get_expanded() << std::endl;
 
-    for (auto it = path4.begin(); it != path4.end(); ++it)
-    {
-        it->vertex->get_value().print(true, false);
-        std::cout << (it != path4.end() - 1 ? " -> " : "");
-    }
+    std::cout << "Bidirectional Dijkstra time: " << bidirectional_dijkstra_time << reinterpret_cast<const char*>(microseconds) << std::endl;
+    std::cout << "Bidirectional A* time: " << bidirectional_astar_time << reinterpret_cast<const char*>(microseconds) << std::endl;
 
     std::cout << std::endl;
+
+    // Jump point search needs every step to cost the same, so the terrain becomes a flat map with the high ground blocked
+    auto flat = GridGraph(width, depth, std::vector<float>(grid.size(), 0.0f), Connectivity::Eight, 0);
+    for (auto i = 0; i < grid.size(); i++)
+        flat.set_blocked(i, i != start_3d && i != goal_3d && grid.get_height(i) > 7.5f);
+    const auto jump_points = JumpPointSearch(flat);
+    const auto jump_table = JumpPointTable(flat);
+
+    start = std::chrono::high_resolution_clock::now();
+    const auto paths7 = astar(flat, start_3d, goal_3d, OctileHeuristic(flat, goal_3d));
+    end = std::chrono::high_resolution_clock::now();
+    const auto flat_astar_time = std::chrono::duration_cast<std::chrono::microseconds>(end - start).count();
+
+    start = std::chrono::high_resolution_clock::now();
+    const auto paths8 = jump_points.search(start_3d, goal_3d);
+    end = std::chrono::high_resolution_clock::now();
+    const auto jps_time = std::chrono::duration_cast<std::chrono::microseconds>(end - start).count();
+
+    start = std::chrono::high_resolution_clock::now();
+    const auto paths9 = jump_table.search(start_3d, goal_3d);
+    const auto path9 = paths9.extract_path(goal_3d, path_buffer_3d);
+    end = std::chrono::high_resolution_clock::now();
+    const auto jps_plus_time = std::chrono::duration_cast<std::chrono::microseconds>(end - start).count();
+
+    print_path(flat, path9);
+
     std::cout << std::endl;
+    std::cout << "Flat distance: " << paths9.get_distance(goal_3d) << std::endl;
+    std::cout << "Flat A* length: " << paths7.get_expanded() << std::endl;
+    std::cout << "JPS length: " << paths8.get_expanded() << std::endl;
+    std::cout << "JPS+ length: " << paths9.get_expanded() << std::endl;
 
-    int astar_length = 0;
-    for(const auto vertex_3d : vertices_3d)
-    {
-        if(!vertex_3d->is_empty())
-            astar_length++;
-        for(const auto edge_3d : vertex_3d->get_edges())
-            vertex_3d->remove_edge(edge_3d);
-    }
+    std::cout << "Flat A* time: " << flat_astar_time << reinterpret_cast<const char*>(microseconds) << std::endl;
+    std::cout << "JPS time: " << jps_time << reinterpret_cast<const char*>(microseconds) << std::endl;
+    std::cout << "JPS+ time: " << jps_plus_time << reinterpret_cast<const char*>(microseconds) << std::endl;
 
-    std::cout << "Graph legnth: " << vertices_3d.size() << std::endl;
-    std::cout << "Dijkstra length: " << dijkstra_length << std::endl;
-    std::cout << "A* length: " << astar_length << std::endl;
+    std::cout << std::endl;
 
-    std::cout << "Dijkstra time: " << dihkstra_time << reinterpret_cast<const char*>(microseconds) << std::endl;
-    std::cout << "A* time: " << astar_time << reinterpret_cast<const char*>(microseconds) << std::endl;
+    // The hierarchy is built once and saved, queries afterwards only search upwards from both ends
+    start = std::chrono::high_resolution_clock::now();
+    const auto built = ContractionHierarchy(grid);
+    end = std::chrono::high_resolution_clock::now();
+    const auto contraction_time = std::chrono::duration_cast<std::chrono::milliseconds>(end - start).count();
+
+    auto stream = std::stringstream(std::ios::in | std::ios::out | std::ios::binary);
+    built.save(stream);
+    const auto hierarchy = ContractionHierarchy::load(stream);
+    auto query = HierarchyQuery(hierarchy);
+
+    start = std::chrono::high_resolution_clock::now();
+    const auto hierarchy_distance = query.distance(start_3d, goal_3d);
+    end = std::chrono::high_resolution_clock::now();
+    const auto hierarchy_time = std::chrono::duration_cast<std::chrono::microseconds>(end - start).count();
+
+    const auto path10 = query.path(start_3d, goal_3d, path_buffer_3d);
+    print_path(grid, path10);
+
+    std::cout << std::endl;
+    std::cout << "Hierarchy distance: " << hierarchy_distance << std::endl;
+    std::cout << "Hierarchy shortcuts: " << hierarchy.shortcut_count() << std::endl;
+    std::cout << "Hierarchy preprocessing time: " << contraction_time << "ms" << std::endl;
+    std::cout << "Hierarchy query time: " << hierarchy_time << reinterpret_cast<const char*>(microseconds) << std::endl;
+
+    std::cout << std::endl;
+
+    // Landmarks only use distances in the graph, so the same A* works on graphs without coordinates
+    start = std::chrono::high_resolution_clock::now();
+    const auto landmarks = Landmarks(grid, grid, 8);
+    end = std::chrono::high_resolution_clock::now();
+    const auto landmark_time = std::chrono::duration_cast<std::chrono::milliseconds>(end - start).count();
+
+    start = std::chrono::high_resolution_clock::now();
+    const auto paths11 = astar(grid, start_3d, goal_3d, LandmarkHeuristic(landmarks, goal_3d));
+    end = std::chrono::high_resolution_clock::now();
+    const auto landmark_astar_time = std::chrono::duration_cast<std::chrono::microseconds>(end - start).count();
+
+    std::cout << "Landmark distance: " << paths11.get_distance(goal_3d) << std::endl;
+    std::cout << "Landmark A* length: " << paths11.get_expanded() << std::endl;
+    std::cout << "Landmark preprocessing time: " << landmark_time << "ms" << std::endl;
+    std::cout << "Landmark A* time: " << landmark_astar_time << reinterpret_cast<const char*>(microseconds) << std::endl;
+
+    std::cout << std::endl;
+
+    // A tick worth of requests between random cells, answered one at a time and then as a batch over every core
+    auto random = std::mt19937(1);
+    auto cells = std::uniform_int_distribution(0, grid.size() - 1);
+    auto queries = std::vector<PathQuery>(1000);
+    for (auto& query : queries)
+        query = { cells(random), cells(random) };
+
+    start = std::chrono::high_resolution_clock::now();
+    auto serial_total = 0.0f;
+    for (const auto& [from, to] : queries)
+        serial_total += astar(grid, from, to, OctileHeuristic(grid, to)).get_distance(to);
+    end = std::chrono::high_resolution_clock::now();
+    const auto serial_time = std::chrono::duration_cast<std::chrono::milliseconds>(end - start).count();
+
+    auto engine = QueryEngine(grid);
+    start = std::chrono::high_resolution_clock::now();
+    const auto batch = engine.run(queries, [&grid](const int goal) { return OctileHeuristic(grid, goal); });
+    end = std::chrono::high_resolution_clock::now();
+    const auto batch_time = std::chrono::duration_cast<std::chrono::milliseconds>(end - start).count();
+
+    auto batch_total = 0.0f;
+    for (auto i = 0; i < batch.size(); i++)
+        batch_total += batch.get_distance(i);
+
+    std::cout << "Batch total distance: " << serial_total << ", " << batch_total << std::endl;
+    std::cout << "Batch threads: " << engine.get_thread_count() << std::endl;
+    std::cout << "Serial queries time: " << serial_time << "ms" << std::endl;
+    std::cout << "Batch queries time: " << batch_time << "ms" << std::endl;
+
+    std::cout << std::endl;
+
+    // Distance to every cell, as for an influence map
+    start = std::chrono::high_resolution_clock::now();
+    const auto everywhere = dijkstra(grid, start_3d);
+    end = std::chrono::high_resolution_clock::now();
+    const auto everywhere_time = std::chrono::duration_cast<std::chrono::microseconds>(end - start).count();
+
+    start = std::chrono::high_resolution_clock::now();
+    const auto stepped = delta_stepping(grid, start_3d);
+    end = std::chrono::high_resolution_clock::now();
+    const auto stepped_time = std::chrono::duration_cast<std::chrono::microseconds>(end - start).count();
+
+    std::cout << "All cells distance: " << everywhere.get_distance(goal_3d) << ", " << stepped.get_distance(goal_3d) << std::endl;
+    std::cout << "Delta-stepping delta: " << choose_delta(grid) << std::endl;
+    std::cout << "All cells Dijkstra time: " << everywhere_time << reinterpret_cast<const char*>(microseconds) << std::endl;
+    std::cout << "Delta-stepping time: " << stepped_time << reinterpret_cast<const char*>(microseconds) << std::endl;
 #pragma endregion functions
 
     return 0;
@@ -0,0 +1,655 @@
+#pragma once
+#include <algorithm>
+#include <cstdint>
+#include <istream>
+#include <limits>
+#include <ostream>
+#include <span>
+#include <stdexcept>
+#include <vector>
+
+#include "IndexedHeap.h"
+#include "PathFinding.h"
+
+/**
+ * \brief Contraction hierarchy of a graph for answering many shortest path queries on the same graph.
+ * Vertexes are removed one at a time in order of importance, and every shortest path that went through a removed
+ * vertex gets a shortcut edge between its neighbours. A query then only has to search upwards in that order from
+ * both ends, which touches a few hundred vertexes instead of a large part of the graph.
+ */
+class ContractionHierarchy
+{
+public:
+    /**
+     * \brief An edge of the hierarchy.
+     */
+    struct Arc
+    {
+        /**
+         * \brief The vertex at the other end of the edge.
+         */
+        int vertex;
+        /**
+         * \brief The distance of the edge.
+         */
+        float weight;
+        /**
+         * \brief The vertex a shortcut skips over, -1 for an edge of the original graph.
+         */
+        int middle;
+    };
+
+private:
+    std::vector<int> ranks;
+    std::vector<int> upward_offsets;
+    std::vector<Arc> upward_arcs;
+    std::vector<int> downward_offsets;
+    std::vector<Arc> downward_arcs;
+
+    // Stop looking for a witness path after this many vertexes or edges on it, adding a shortcut that is not needed is
+    // still correct. Priorities only estimate the shortcuts, so they look less far than the contraction itself
+    static constexpr int witness_settle_limit = 500;
+    static constexpr int witness_hop_limit = 5;
+    static constexpr int simulated_hop_limit = 3;
+
+    ContractionHierarchy() = default;
+    void build(std::vector<std::vector<Arc>> outgoing);
+public:
+    /**
+     * \brief Contracts a graph, the edges are read once and the graph is not used afterwards.
+     * \tparam G The type of the graph, it needs size() and for_each_neighbor(vertex, f).
+     * \param graph The graph to contract, edges may go one way only.
+     */
+    template <class G>
+    explicit ContractionHierarchy(const G& graph);
+
+    /**
+     * \brief Gets the edges from a vertex to vertexes contracted after it.
+     * \param vertex The index of the vertex.
+     * \return The upward edges leaving the vertex.
+     */
+    [[nodiscard]] std::span<const Arc> get_upward(int vertex) const;
+
+    /**
+     * \brief Gets the edges into a vertex from vertexes contracted after it.
+     * \param vertex The index of the vertex.
+     * \return The edges entering the vertex from above, with the vertex they come from.
+     */
+    [[nodiscard]] std::span<const Arc> get_downward(int vertex) const;
+
+    /**
+     * \brief Gets the position of a vertex in the contraction order.
+     * \param vertex The index of the vertex.
+     * \return The rank of the vertex, higher ranks are more important.
+     */
+    [[nodiscard]] int get_rank(int vertex) const;
+
+    /**
+     * \brief Gets the amount of shortcut edges the contraction added.
+     * \return The amount of shortcuts.
+     */
+    [[nodiscard]] int shortcut_count() const;
+
+    /**
+     * \brief Finds the shortest path between two vertexes. This allocates arrays for the whole graph,
+     * HierarchyQuery reuses them between queries.
+     * \param start The index of the starting vertex.
+     * \param goal The index of the goal vertex.
+     * \return The shortest path to the goal with every vertex on it filled in.
+     */
+    [[nodiscard]] ShortestPaths search(int start, int goal) const;
+
+    /**
+     * \brief Writes the hierarchy in a binary format.
+     * \param stream The stream to write to, opened in binary mode.
+     */
+    void save(std::ostream& stream) const;
+
+    /**
+     * \brief Reads a hierarchy written by save.
+     * \param stream The stream to read from, opened in binary mode.
+     * \return The hierarchy.
+     */
+    static ContractionHierarchy load(std::istream& stream);
+
+    /**
+     * \brief Gets the amount of vertexes in the hierarchy.
+     * \return The amount of vertexes in the hierarchy.
+     */
+    [[nodiscard]] int size() const;
+};
+
+/**
+ * \brief Reusable state for queries on a contraction hierarchy, one per thread.
+ * Only the entries a query touched are reset before the next one, so a query costs nothing for the untouched graph.
+ */
+class HierarchyQuery
+{
+    // A shortcut from -> to over middle that still has to be unpacked
+    struct Pending
+    {
+        int from;
+        int to;
+        int middle;
+    };
+
+    const ContractionHierarchy* hierarchy;
+    std::vector<float> forward_distances;
+    std::vector<float> backward_distances;
+    std::vector<int> forward_parents;
+    std::vector<int> backward_parents;
+    std::vector<int> touched;
+    IndexedHeap<float> forward_open;
+    IndexedHeap<float> backward_open;
+    int meeting = -1;
+    // Buffers of path, kept between queries so a path does not allocate once they are large enough
+    std::vector<int> packed;
+    std::vector<int> unpacked;
+    std::vector<Pending> stack;
+
+    void reset();
+    void unpack(int from, int to, int middle);
+    [[nodiscard]] const ContractionHierarchy::Arc& find_arc(std::span<const ContractionHierarchy::Arc> arcs, int vertex) const;
+public:
+    /**
+     * \brief Creates the query state for a hierarchy.
+     * \param hierarchy The hierarchy to query, it has to outlive the query state.
+     */
+    explicit HierarchyQuery(const ContractionHierarchy& hierarchy);
+
+    /**
+     * \brief Finds the length of the shortest path between two vertexes.
+     * \param start The index of the starting vertex.
+     * \param goal The index of the goal vertex.
+     * \return The length of the shortest path, infinity if the goal can not be reached.
+     */
+    float distance(int start, int goal);
+
+    /**
+     * \brief Writes the shortest path between two vertexes into a buffer, with shortcuts replaced by the original edges.
+     * \param start The index of the starting vertex.
+     * \param goal The index of the goal vertex.
+     * \param output The buffer to write the path to.
+     * \return The part of the buffer that holds the path, empty if the goal can not be reached.
+     */
+    std::span<int> path(int start, int goal, std::span<int> output);
+};
+
+template <class G>
+ContractionHierarchy::ContractionHierarchy(const G& graph)
+{
+    auto outgoing = std::vector<std::vector<Arc>>(graph.size());
+    for (auto vertex = 0; vertex < graph.size(); vertex++)
+    {
+        graph.for_each_neighbor(vertex, [&](const int to, const float weight)
+        {
+            if (to == vertex)
+                return;
+            // Parallel edges collapse into the shortest one
+            auto& arcs = outgoing[vertex];
+            const auto existing = std::ranges::find_if(arcs, [to](const Arc& arc) { return arc.vertex == to; });
+            if (existing == arcs.end())
+                arcs.push_back({ to, weight, -1 });
+            else
+                existing->weight = std::min(existing->weight, weight);
+        });
+    }
+    this->build(std::move(outgoing));
+}
+
+inline void ContractionHierarchy::build(std::vector<std::vector<Arc>> outgoing)
+{
+    const auto count = static_cast<int>(outgoing.size());
+    auto incoming = std::vector<std::vector<Arc>>(count);
+    for (auto vertex = 0; vertex < count; vertex++)
+    {
+        for (const auto& arc : outgoing[vertex])
+            incoming[arc.vertex].push_back({ vertex, arc.weight, arc.middle });
+    }
+
+    const auto add_arc = [&outgoing, &incoming](const int from, const int to, const float weight, const int middle)
+    {
+        auto& arcs = outgoing[from];
+        const auto existing = std::ranges::find_if(arcs, [to](const Arc& arc) { return arc.vertex == to; });
+        if (existing == arcs.end())
+        {
+            arcs.push_back({ to, weight, middle });
+            incoming[to].push_back({ from, weight, middle });
+            return;
+        }
+        if (existing->weight <= weight)
+            return;
+        *existing = { to, weight, middle };
+        *std::ranges::find_if(incoming[to], [from](const Arc& arc) { return arc.vertex == from; }) = { from, weight, middle };
+    };
+
+    // Local Dijkstra that looks for a path around the vertex being contracted. A target is done as soon as some path to
+    // it is no longer than the one through the vertex, it does not have to be settled
+    auto witness_distances = std::vector<float>(count, std::numeric_limits<float>::infinity());
+    auto witness_hops = std::vector<int>(count, 0);
+    auto witness_touched = std::vector<int>();
+    auto witness_open = IndexedHeap<float>(count);
+    auto target_limits = std::vector<float>(count, -1.0f);
+    const auto find_witnesses = [&](const int source, const int excluded, const float limit, const int hop_limit, int targets)
+    {
+        for (const auto vertex : witness_touched)
+            witness_distances[vertex] = std::numeric_limits<float>::infinity();
+        witness_touched.clear();
+        witness_open.clear();
+        witness_distances[source] = 0;
+        witness_hops[source] = 0;
+        witness_touched.push_back(source);
+        witness_open.push(source, 0);
+        for (auto settled = 0; !witness_open.is_empty() && settled < witness_settle_limit && targets > 0; settled++)
+        {
+            if (witness_open.top_key() > limit)
+                break;
+            const auto vertex = witness_open.pop();
+            if (witness_hops[vertex] == hop_limit)
+                continue;
+            for (const auto& arc : outgoing[vertex])
+            {
+                const auto distance = witness_distances[vertex] + arc.weight;
+                if (arc.vertex == excluded || distance > limit || distance >= witness_distances[arc.vertex])
+                    continue;
+                if (witness_distances[arc.vertex] > target_limits[arc.vertex] && distance <= target_limits[arc.vertex])
+                    targets--;
+                if (witness_distances[arc.vertex] == std::numeric_limits<float>::infinity())
+                    witness_touched.push_back(arc.vertex);
+                witness_distances[arc.vertex] = distance;
+                witness_hops[arc.vertex] = witness_hops[vertex] + 1;
+                witness_open.push_or_decrease(arc.vertex, distance);
+            }
+        }
+    };
+
+    // Counts, or adds, the shortcuts needed to remove a vertex
+    const auto contract = [&](const int vertex, const bool simulate)
+    {
+        auto shortcuts = 0;
+        for (const auto& in : incoming[vertex])
+        {
+            auto limit = -1.0f;
+            auto targets = 0;
+            for (const auto& out : outgoing[vertex])
+            {
+                if (out.vertex == in.vertex)
+                    continue;
+                target_limits[out.vertex] = in.weight + out.weight;
+                limit = std::max(limit, in.weight + out.weight);
+                targets++;
+            }
+            if (targets > 0)
+                find_witnesses(in.vertex, vertex, limit, simulate ? simulated_hop_limit : witness_hop_limit, targets);
+            for (const auto& out : outgoing[vertex])
+            {
+                if (out.vertex == in.vertex)
+                    continue;
+                target_limits[out.vertex] = -1.0f;
+                const auto via = in.weight + out.weight;
+                if (witness_distances[out.vertex] <= via)
+                    continue;
+                shortcuts++;
+                if (!simulate)
+                    add_arc(in.vertex, out.vertex, via, vertex);
+            }
+        }
+        return shortcuts;
+    };
+
+    // Edge difference, plus the contracted neighbours and the depth in the hierarchy so the contraction spreads evenly over the graph
+    auto deleted_neighbors = std::vector<int>(count, 0);
+    auto levels = std::vector<int>(count, 0);
+    const auto priority = [&](const int vertex)
+    {
+        const auto removed = static_cast<int>(incoming[vertex].size() + outgoing[vertex].size());
+        return static_cast<float>(2 * (contract(vertex, true) - removed) + deleted_neighbors[vertex] + levels[vertex]);
+    };
+
+    auto queue = IndexedHeap<float>(count);
+    for (auto vertex = 0; vertex < count; vertex++)
+        queue.push(vertex, priority(vertex));
+
+    auto upward = std::vector<std::vector<Arc>>(count);
+    auto downward = std::vector<std::vector<Arc>>(count);
+    this->ranks = std::vector<int>(count, -1);
+    auto rank = 0;
+    while (!queue.is_empty())
+    {
+        // Priorities go stale as the graph changes, a vertex that got worse goes back in the queue
+        const auto vertex = queue.pop();
+        const auto current = priority(vertex);
+        if (!queue.is_empty() && current > queue.top_key())
+        {
+            queue.push(vertex, current);
+            continue;
+        }
+
+        contract(vertex, false);
+        this->ranks[vertex] = rank++;
+        upward[vertex] = outgoing[vertex];
+        downward[vertex] = incoming[vertex];
+
+        auto neighbors = std::vector<int>();
+        for (const auto& out : outgoing[vertex])
+        {
+            std::erase_if(incoming[out.vertex], [vertex](const Arc& arc) { return arc.vertex == vertex; });
+            neighbors.push_back(out.vertex);
+        }
+        for (const auto& in : incoming[vertex])
+        {
+            std::erase_if(outgoing[in.vertex], [vertex](const Arc& arc) { return arc.vertex == vertex; });
+            neighbors.push_back(in.vertex);
+        }
+        outgoing[vertex] = std::vector<Arc>();
+        incoming[vertex] = std::vector<Arc>();
+
+        std::ranges::sort(neighbors);
+        neighbors.erase(std::unique(neighbors.begin(), neighbors.end()), neighbors.end());
+        // Only the counters change here, the full priorities are recomputed lazily when the neighbours are popped
+        for (const auto neighbor : neighbors)
+        {
+            deleted_neighbors[neighbor]++;
+            levels[neighbor] = std::max(levels[neighbor], levels[vertex] + 1);
+        }
+    }
+
+    const auto compress = [count](const std::vector<std::vector<Arc>>& lists, std::vector<int>& offsets, std::vector<Arc>& arcs)
+    {
+        offsets = std::vector<int>(count + 1, 0);
+        for (auto vertex = 0; vertex < count; vertex++)
+            offsets[vertex + 1] = offsets[vertex] + static_cast<int>(lists[vertex].size());
+        arcs.clear();
+        arcs.reserve(offsets[count]);
+        for (const auto& list : lists)
+            arcs.insert(arcs.end(), list.begin(), list.end());
+    };
+    compress(upward, this->upward_offsets, this->upward_arcs);
+    compress(downward, this->downward_offsets, this->downward_arcs);
+}
+
+inline std::span<const ContractionHierarchy::Arc> ContractionHierarchy::get_upward(int vertex) const
+{
+    return std::span<const Arc>(this->upward_arcs).subspan(this->upward_offsets[vertex], this->upward_offsets[vertex + 1] - this->upward_offsets[vertex]);
+}
+
+inline std::span<const ContractionHierarchy::Arc> ContractionHierarchy::get_downward(int vertex) const
+{
+    return std::span<const Arc>(this->downward_arcs).subspan(this->downward_offsets[vertex], this->downward_offsets[vertex + 1] - this->downward_offsets[vertex]);
+}
+
+inline int ContractionHierarchy::get_rank(int vertex) const
+{
+    return this->ranks[vertex];
+}
+
+inline int ContractionHierarchy::shortcut_count() const
+{
+    const auto is_shortcut = [](const Arc& arc) { return arc.middle != -1; };
+    return static_cast<int>(std::ranges::count_if(this->upward_arcs, is_shortcut) + std::ranges::count_if(this->downward_arcs, is_shortcut));
+}
+
+inline ShortestPaths ContractionHierarchy::search(int start, int goal) const
+{
+    auto query = HierarchyQuery(*this);
+    auto buffer = std::vector<int>(this->size());
+    const auto path = query.path(start, goal, buffer);
+    auto paths = ShortestPaths(this->size());
+    if (path.empty())
+        return paths;
+
+    // The distance along the unpacked path comes from the original edges, which are the downward or upward arcs without a middle
+    paths.set(start, 0, -1);
+    for (size_t i = 1; i < path.size(); i++)
+    {
+        const auto from = path[i - 1];
+        const auto to = path[i];
+        const auto arcs = this->ranks[from] < this->ranks[to] ? this->get_upward(from) : this->get_downward(to);
+        const auto other = this->ranks[from] < this->ranks[to] ? to : from;
+        auto weight = std::numeric_limits<float>::infinity();
+        for (const auto& arc : arcs)
+        {
+            if (arc.vertex == other)
+                weight = arc.weight;
+        }
+        paths.set(to, paths.get_distance(from) + weight, from);
+    }
+    paths.count_expansion(static_cast<int>(path.size()));
+    return paths;
+}
+
+inline void ContractionHierarchy::save(std::ostream& stream) const
+{
+    static_assert(sizeof(Arc) == 12, "Arcs are written as three 4 byte fields");
+    const auto write = [&stream](const void* data, const size_t bytes)
+    {
+        stream.write(static_cast<const char*>(data), static_cast<std::streamsize>(bytes));
+    };
+    const int32_t header[] = { 0x31484321, this->size(), static_cast<int32_t>(this->upward_arcs.size()), static_cast<int32_t>(this->downward_arcs.size()) };
+    write(header, sizeof(header));
+    write(this->ranks.data(), this->ranks.size() * sizeof(int));
+    write(this->upward_offsets.data(), this->upward_offsets.size() * sizeof(int));
+    write(this->upward_arcs.data(), this->upward_arcs.size() * sizeof(Arc));
+    write(this->downward_offsets.data(), this->downward_offsets.size() * sizeof(int));
+    write(this->downward_arcs.data(), this->downward_arcs.size() * sizeof(Arc));
+    if (!stream)
+        throw std::runtime_error("Could not write the contraction hierarchy");
+}
+
+inline ContractionHierarchy ContractionHierarchy::load(std::istream& stream)
+{
+    const auto read = [&stream](void* data, const size_t bytes)
+    {
+        stream.read(static_cast<char*>(data), static_cast<std::streamsize>(bytes));
+        if (!stream)
+            throw std::runtime_error("The contraction hierarchy is truncated");
+    };
+    int32_t header[4];
+    read(header, sizeof(header));
+    if (header[0] != 0x31484321 || header[1] < 0 || header[2] < 0 || header[3] < 0)
+        throw std::runtime_error("The stream does not hold a contraction hierarchy");
+
+    auto hierarchy = ContractionHierarchy();
+    hierarchy.ranks = std::vector<int>(header[1]);
+    hierarchy.upward_offsets = std::vector<int>(header[1] + 1);
+    hierarchy.upward_arcs = std::vector<Arc>(header[2]);
+    hierarchy.downward_offsets = std::vector<int>(header[1] + 1);
+    hierarchy.downward_arcs = std::vector<Arc>(header[3]);
+    read(hierarchy.ranks.data(), hierarchy.ranks.size() * sizeof(int));
+    read(hierarchy.upward_offsets.data(), hierarchy.upward_offsets.size() * sizeof(int));
+    read(hierarchy.upward_arcs.data(), hierarchy.upward_arcs.size() * sizeof(Arc));
+    read(hierarchy.downward_offsets.data(), hierarchy.downward_offsets.size() * sizeof(int));
+    read(hierarchy.downward_arcs.data(), hierarchy.downward_arcs.size() * sizeof(Arc));
+
+    // Queries index with every value read here, so a damaged file has to fail now instead of reading out of bounds later
+    const auto count = header[1];
+    const auto corrupt = std::runtime_error("The contraction hierarchy is corrupt");
+    auto seen = std::vector<bool>(count, false);
+    for (const auto rank : hierarchy.ranks)
+    {
+        if (rank < 0 || rank >= count || seen[rank])
+            throw corrupt;
+        seen[rank] = true;
+    }
+    const auto valid_offsets = [](const std::vector<int>& offsets, const int arcs)
+    {
+        return offsets.front() == 0 && offsets.back() == arcs && std::ranges::is_sorted(offsets);
+    };
+    if (!valid_offsets(hierarchy.upward_offsets, header[2]) || !valid_offsets(hierarchy.downward_offsets, header[3]))
+        throw corrupt;
+    // Both lists of a vertex lead to higher ranks and a shortcut skips a lower one, which bounds the unpacking depth
+    const auto valid_arc = [&hierarchy, count](const int vertex, const Arc& arc)
+    {
+        if (!(arc.weight >= 0) || arc.vertex < 0 || arc.vertex >= count || hierarchy.ranks[arc.vertex] <= hierarchy.ranks[vertex])
+            return false;
+        return arc.middle == -1 || (arc.middle >= 0 && arc.middle < count && hierarchy.ranks[arc.middle] < hierarchy.ranks[vertex]);
+    };
+    const auto has_arc = [](const std::span<const Arc> arcs, const int vertex)
+    {
+        return std::ranges::any_of(arcs, [vertex](const Arc& arc) { return arc.vertex == vertex; });
+    };
+    for (auto vertex = 0; vertex < count; vertex++)
+    {
+        for (const auto& arc : hierarchy.get_upward(vertex))
+        {
+            if (!valid_arc(vertex, arc))
+                throw corrupt;
+            if (arc.middle != -1 && (!has_arc(hierarchy.get_downward(arc.middle), vertex) || !has_arc(hierarchy.get_upward(arc.middle), arc.vertex)))
+                throw corrupt;
+        }
+        for (const auto& arc : hierarchy.get_downward(vertex))
+        {
+            if (!valid_arc(vertex, arc))
+                throw corrupt;
+            if (arc.middle != -1 && (!has_arc(hierarchy.get_downward(arc.middle), arc.vertex) || !has_arc(hierarchy.get_upward(arc.middle), vertex)))
+                throw corrupt;
+        }
+    }
+    return hierarchy;
+}
+
+inline int ContractionHierarchy::size() const
+{
+    return static_cast<int>(this->ranks.size());
+}
+
+inline HierarchyQuery::HierarchyQuery(const ContractionHierarchy& hierarchy)
+    : forward_open(hierarchy.size()), backward_open(hierarchy.size())
+{
+    this->hierarchy = &hierarchy;
+    this->forward_distances = std::vector<float>(hierarchy.size(), std::numeric_limits<float>::infinity());
+    this->backward_distances = std::vector<float>(hierarchy.size(), std::numeric_limits<float>::infinity());
+    this->forward_parents = std::vector<int>(hierarchy.size(), -1);
+    this->backward_parents = std::vector<int>(hierarchy.size(), -1);
+}
+
+inline void HierarchyQuery::reset()
+{
+    for (const auto vertex : this->touched)
+    {
+        this->forward_distances[vertex] = std::numeric_limits<float>::infinity();
+        this->backward_distances[vertex] = std::numeric_limits<float>::infinity();
+        this->forward_parents[vertex] = -1;
+        this->backward_parents[vertex] = -1;
+    }
+    this->touched.clear();
+    this->forward_open.clear();
+    this->backward_open.clear();
+    this->meeting = -1;
+}
+
+inline float HierarchyQuery::distance(int start, int goal)
+{
+    this->reset();
+    this->forward_distances[start] = 0;
+    this->backward_distances[goal] = 0;
+    this->touched.push_back(start);
+    this->touched.push_back(goal);
+    this->forward_open.push(start, 0);
+    this->backward_open.push(goal, 0);
+    auto best = std::numeric_limits<float>::infinity();
+    if (start == goal)
+    {
+        this->meeting = start;
+        best = 0;
+    }
+
+    // Both searches only go up, a side is done once its smallest distance can not improve the best connection
+    auto forward = true;
+    while (true)
+    {
+        const auto forward_done = this->forward_open.is_empty() || this->forward_open.top_key() >= best;
+        const auto backward_done = this->backward_open.is_empty() || this->backward_open.top_key() >= best;
+        if (forward_done && backward_done)
+            break;
+        forward = forward_done ? false : backward_done ? true : !forward;
+
+        auto& open = forward ? this->forward_open : this->backward_open;
+        auto& distances = forward ? this->forward_distances : this->backward_distances;
+        auto& parents = forward ? this->forward_parents : this->backward_parents;
+        const auto& other = forward ? this->backward_distances : this->forward_distances;
+        const auto vertex = open.pop();
+        const auto distance = distances[vertex];
+        if (distance + other[vertex] < best)
+        {
+            best = distance + other[vertex];
+            this->meeting = vertex;
+        }
+
+        // Stall on demand, a shorter way in from a higher vertex means no shortest path goes up through this one
+        const auto stalled = std::ranges::any_of(forward ? this->hierarchy->get_downward(vertex) : this->hierarchy->get_upward(vertex), [&](const ContractionHierarchy::Arc& arc)
+        {
+            return distances[arc.vertex] + arc.weight < distance;
+        });
+        if (stalled)
+            continue;
+        for (const auto& arc : forward ? this->hierarchy->get_upward(vertex) : this->hierarchy->get_downward(vertex))
+        {
+            const auto computed_distance = distance + arc.weight;
+            if (computed_distance >= distances[arc.vertex])
+                continue;
+            if (this->forward_distances[arc.vertex] == std::numeric_limits<float>::infinity() && this->backward_distances[arc.vertex] == std::numeric_limits<float>::infinity())
+                this->touched.push_back(arc.vertex);
+            distances[arc.vertex] = computed_distance;
+            parents[arc.vertex] = vertex;
+            open.push_or_decrease(arc.vertex, computed_distance);
+        }
+    }
+    return best;
+}
+
+inline const ContractionHierarchy::Arc& HierarchyQuery::find_arc(std::span<const ContractionHierarchy::Arc> arcs, int vertex) const
+{
+    return *std::ranges::find_if(arcs, [vertex](const ContractionHierarchy::Arc& arc) { return arc.vertex == vertex; });
+}
+
+inline void HierarchyQuery::unpack(int from, int to, int middle)
+{
+    // A shortcut from -> to over middle is the arc from -> middle, stored downward at middle, followed by the arc
+    // middle -> to, stored upward at middle. Both may be shortcuts themselves, so the halves are unpacked from a stack.
+    this->stack.clear();
+    this->stack.push_back({ from, to, middle });
+    while (!this->stack.empty())
+    {
+        const auto [a, b, m] = this->stack.back();
+        this->stack.pop_back();
+        if (m == -1)
+        {
+            this->unpacked.push_back(b);
+            continue;
+        }
+        const auto& second = this->find_arc(this->hierarchy->get_upward(m), b);
+        const auto& first = this->find_arc(this->hierarchy->get_downward(m), a);
+        this->stack.push_back({ m, b, second.middle });
+        this->stack.push_back({ a, m, first.middle });
+    }
+}
+
+inline std::span<int> HierarchyQuery::path(int start, int goal, std::span<int> output)
+{
+    if (this->distance(start, goal) == std::numeric_limits<float>::infinity())
+        return output.first(0);
+
+    // The packed path goes up from the start to the meeting vertex and down to the goal
+    this->packed.clear();
+    for (auto vertex = this->meeting; vertex != -1; vertex = this->forward_parents[vertex])
+        this->packed.push_back(vertex);
+    std::ranges::reverse(this->packed);
+    for (auto vertex = this->backward_parents[this->meeting]; vertex != -1; vertex = this->backward_parents[vertex])
+        this->packed.push_back(vertex);
+
+    this->unpacked.clear();
+    this->unpacked.push_back(start);
+    for (size_t i = 1; i < this->packed.size(); i++)
+    {
+        const auto from = this->packed[i - 1];
+        const auto to = this->packed[i];
+        const auto upward = this->hierarchy->get_rank(from) < this->hierarchy->get_rank(to);
+        const auto& arc = upward ? this->find_arc(this->hierarchy->get_upward(from), to) : this->find_arc(this->hierarchy->get_downward(to), from);
+        this->unpack(from, to, arc.middle);
+    }
+    if (this->unpacked.size() > output.size())
+        throw std::length_error("The output buffer is shorter than the path");
+    std::ranges::copy(this->unpacked, output.begin());
+    return output.first(this->unpacked.size());
+}
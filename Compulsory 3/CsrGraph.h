@@ -0,0 +1,210 @@
+#pragma once
+#include <span>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "Graph.h"
+
+/**
+ * \brief Immutable compressed sparse row snapshot of a graph.
+ * The edges of vertex i are stored contiguously from offsets[i] to offsets[i + 1] in the target and weight arrays,
+ * so scanning the neighbours of a vertex is a sequential read instead of a pointer chase through Edge objects.
+ * \tparam T The type of the value in the vertexes.
+ */
+template <class T>
+class CsrGraph
+{
+    std::vector<int> offsets;
+    std::vector<int> targets;
+    std::vector<float> weights;
+    std::vector<T> values;
+public:
+    /**
+     * \brief Creates an empty graph.
+     */
+    CsrGraph();
+
+    /**
+     * \brief Creates a snapshot of the given graph. Vertex i of the snapshot is graph[i].
+     * Edges to vertexes that are not part of the graph are left out.
+     * \param graph The graph to copy.
+     */
+    explicit CsrGraph(const Graph<T>& graph);
+
+    /**
+     * \brief Creates a graph from already compressed arrays.
+     * \param offsets The first edge of every vertex, followed by the total amount of edges.
+     * \param targets The vertex each edge leads to.
+     * \param weights The distance of each edge.
+     * \param values The value of each vertex.
+     */
+    CsrGraph(std::vector<int> offsets, std::vector<int> targets, std::vector<float> weights, std::vector<T> values);
+
+    /**
+     * \brief Creates a graph with every edge reversed, for searching backwards from a goal.
+     * \return The transposed graph.
+     */
+    [[nodiscard]] CsrGraph transposed() const;
+
+    /**
+     * \brief Gets the vertexes the edges of a vertex lead to.
+     * \param vertex The index of the vertex.
+     * \return The targets of the edges, in the same order as get_weights.
+     */
+    [[nodiscard]] std::span<const int> get_targets(int vertex) const;
+
+    /**
+     * \brief Gets the distances of the edges of a vertex.
+     * \param vertex The index of the vertex.
+     * \return The distances of the edges, in the same order as get_targets.
+     */
+    [[nodiscard]] std::span<const float> get_weights(int vertex) const;
+
+    /**
+     * \brief Calls a function for every edge of a vertex.
+     * \param vertex The index of the vertex.
+     * \param f The function to call with the target index and the distance of each edge.
+     */
+    template <typename Func>
+    void for_each_neighbor(int vertex, Func f) const;
+
+    /**
+     * \brief Gets the value of a vertex.
+     * \param vertex The index of the vertex.
+     * \return The value of the vertex.
+     */
+    [[nodiscard]] T get_value(int vertex) const;
+
+    /**
+     * \brief Gets the amount of edges leaving a vertex.
+     * \param vertex The index of the vertex.
+     * \return The amount of edges leaving the vertex.
+     */
+    [[nodiscard]] int get_degree(int vertex) const;
+
+    /**
+     * \brief Gets the amount of edges in the graph.
+     * \return The amount of edges in the graph.
+     */
+    [[nodiscard]] int edge_count() const;
+
+    /**
+     * \brief Gets the amount of vertexes in the graph.
+     * \return The amount of vertexes in the graph.
+     */
+    [[nodiscard]] int size() const;
+};
+
+template <class T>
+CsrGraph<T>::CsrGraph()
+{
+    this->offsets = std::vector<int>(1, 0);
+}
+
+template <class T>
+CsrGraph<T>::CsrGraph(const Graph<T>& graph)
+{
+    const auto vertices = graph.get_vertices();
+    auto indices = std::unordered_map<const Vertex<T>*, int>();
+    indices.reserve(vertices.size());
+    for (auto i = 0; i < static_cast<int>(vertices.size()); i++)
+        indices.insert({ vertices[i], i });
+
+    this->offsets.reserve(vertices.size() + 1);
+    this->values.reserve(vertices.size());
+    this->offsets.push_back(0);
+    for (const auto vertex : vertices)
+    {
+        for (const auto edge : vertex->get_edges())
+        {
+            const auto to = indices.find(edge->get_to());
+            if (to == indices.end())
+                continue;
+            this->targets.push_back(to->second);
+            this->weights.push_back(edge->get_distance());
+        }
+        this->offsets.push_back(static_cast<int>(this->targets.size()));
+        this->values.push_back(vertex->get_value());
+    }
+    this->targets.shrink_to_fit();
+    this->weights.shrink_to_fit();
+}
+
+template <class T>
+CsrGraph<T>::CsrGraph(std::vector<int> offsets, std::vector<int> targets, std::vector<float> weights, std::vector<T> values)
+{
+    this->offsets = std::move(offsets);
+    this->targets = std::move(targets);
+    this->weights = std::move(weights);
+    this->values = std::move(values);
+}
+
+template <class T>
+CsrGraph<T> CsrGraph<T>::transposed() const
+{
+    // Counting sort of the edges by target
+    auto reversed_offsets = std::vector<int>(this->offsets.size(), 0);
+    for (const auto target : this->targets)
+        reversed_offsets[target + 1]++;
+    for (size_t i = 1; i < reversed_offsets.size(); i++)
+        reversed_offsets[i] += reversed_offsets[i - 1];
+
+    auto next = std::vector<int>(reversed_offsets.begin(), reversed_offsets.end() - 1);
+    auto reversed_targets = std::vector<int>(this->targets.size());
+    auto reversed_weights = std::vector<float>(this->weights.size());
+    for (auto vertex = 0; vertex < this->size(); vertex++)
+    {
+        for (auto i = this->offsets[vertex]; i < this->offsets[vertex + 1]; i++)
+        {
+            const auto slot = next[this->targets[i]]++;
+            reversed_targets[slot] = vertex;
+            reversed_weights[slot] = this->weights[i];
+        }
+    }
+    return CsrGraph(std::move(reversed_offsets), std::move(reversed_targets), std::move(reversed_weights), this->values);
+}
+
+template <class T>
+std::span<const int> CsrGraph<T>::get_targets(int vertex) const
+{
+    return std::span<const int>(this->targets).subspan(this->offsets[vertex], this->offsets[vertex + 1] - this->offsets[vertex]);
+}
+
+template <class T>
+std::span<const float> CsrGraph<T>::get_weights(int vertex) const
+{
+    return std::span<const float>(this->weights).subspan(this->offsets[vertex], this->offsets[vertex + 1] - this->offsets[vertex]);
+}
+
+template <class T>
+template <typename Func>
+void CsrGraph<T>::for_each_neighbor(int vertex, Func f) const
+{
+    for (auto i = this->offsets[vertex]; i < this->offsets[vertex + 1]; i++)
+        f(this->targets[i], this->weights[i]);
+}
+
+template <class T>
+T CsrGraph<T>::get_value(int vertex) const
+{
+    return this->values[vertex];
+}
+
+template <class T>
+int CsrGraph<T>::get_degree(int vertex) const
+{
+    return this->offsets[vertex + 1] - this->offsets[vertex];
+}
+
+template <class T>
+int CsrGraph<T>::edge_count() const
+{
+    return static_cast<int>(this->targets.size());
+}
+
+template <class T>
+int CsrGraph<T>::size() const
+{
+    return static_cast<int>(this->offsets.size()) - 1;
+}
@@ -0,0 +1,292 @@
+#pragma once
+#include <algorithm>
+#include <atomic>
+#include <barrier>
+#include <bit>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <stdexcept>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "PathFinding.h"
+
+/**
+ * \brief Packs a distance and a predecessor into one value that orders by distance first.
+ * Non negative floats order the same as their bit patterns, so the pair can be lowered with one atomic compare and swap.
+ * \param distance The distance, not negative.
+ * \param predecessor The index of the previous vertex, -1 for none.
+ * \return The packed pair.
+ */
+inline uint64_t pack_distance(const float distance, const int predecessor)
+{
+    return static_cast<uint64_t>(std::bit_cast<uint32_t>(distance)) << 32 | static_cast<uint32_t>(predecessor);
+}
+
+/**
+ * \brief Gets the distance out of a value made by pack_distance.
+ * \param packed The packed pair.
+ * \return The distance.
+ */
+inline float unpack_distance(const uint64_t packed)
+{
+    return std::bit_cast<float>(static_cast<uint32_t>(packed >> 32));
+}
+
+/**
+ * \brief Gets the predecessor out of a value made by pack_distance.
+ * \param packed The packed pair.
+ * \return The index of the previous vertex, -1 for none.
+ */
+inline int unpack_predecessor(const uint64_t packed)
+{
+    return static_cast<int>(static_cast<uint32_t>(packed));
+}
+
+/**
+ * \brief Lowers a packed distance if the new one is smaller, safe to call from several threads.
+ * \param slot The packed distance of a vertex.
+ * \param packed The new packed distance.
+ * \return True if the slot was lowered.
+ */
+inline bool relax_min(std::atomic<uint64_t>& slot, const uint64_t packed)
+{
+    auto current = slot.load(std::memory_order_relaxed);
+    while (packed < current)
+    {
+        if (slot.compare_exchange_weak(current, packed, std::memory_order_relaxed))
+            return true;
+    }
+    return false;
+}
+
+/**
+ * \brief Picks a bucket width for delta_stepping, the average weight of the edges of about a thousand vertexes.
+ * With that width a bucket holds about one step of the search front, which keeps the amount of phases close to the
+ * amount of steps in the longest path while vertexes are rarely relaxed more than once.
+ * \tparam G The type of the graph, it needs size() and for_each_neighbor(vertex, f).
+ * \param graph The graph to pick the width for.
+ * \return The bucket width.
+ */
+template <class G>
+float choose_delta(const G& graph)
+{
+    const auto step = std::max(1, graph.size() / 1024);
+    auto total = 0.0;
+    auto count = 0;
+    for (auto vertex = 0; vertex < graph.size(); vertex += step)
+    {
+        graph.for_each_neighbor(vertex, [&](int, const float weight)
+        {
+            total += weight;
+            count++;
+        });
+    }
+    return total > 0 ? static_cast<float>(total / count) : 1.0f;
+}
+
+/**
+ * \brief Finds the shortest paths from a vertex to every vertex with delta-stepping, in parallel.
+ * Vertexes are put in buckets of width delta by distance. An edge reaches at most max_weight / delta buckets past the
+ * current one, so a ring of that many buckets plus two is reused cyclically. The lowest bucket is emptied in rounds that relax the
+ * light edges (weight up to delta) of its vertexes, since those can put vertexes back into the same bucket, and then
+ * the heavy edges of everything that was in it are relaxed once. Every round is split over the threads, which lower
+ * distances with an atomic minimum, and the buckets are updated between rounds while the threads wait at a barrier.
+ * The edges are copied once up front with the light ones of every vertex before its heavy ones, so each round only
+ * reads the edges it relaxes.
+ * \tparam G The type of the graph, it needs size() and for_each_neighbor(vertex, f) that are safe to call from several threads.
+ * \param graph The graph to search, edge weights must be finite and not negative.
+ * \param start The index of the starting vertex.
+ * \param delta The bucket width, 0 to pick it with choose_delta.
+ * \param thread_count The amount of threads to use, 0 for one per hardware thread.
+ * \return The shortest paths to every vertex, with the amount of vertex scans that had edges to relax as the expansions.
+ * \throws std::invalid_argument If an edge weight is negative or not finite, or delta is too small for the weights.
+ */
+template <class G>
+ShortestPaths delta_stepping(const G& graph, const int start, float delta = 0, int thread_count = 0)
+{
+    const auto size = graph.size();
+    if (!(delta > 0))
+        delta = choose_delta(graph);
+
+    // The edges of vertex i are light from offsets[i] to splits[i] and heavy from there to offsets[i + 1]
+    auto offsets = std::vector<int>(size + 1, 0);
+    auto splits = std::vector<int>(size, 0);
+    auto edges = std::vector<std::pair<int, float>>();
+    auto deferred = std::vector<std::pair<int, float>>();
+    // Growing the copy of a large graph costs about as much as the search, so its size is estimated from a sample
+    const auto step = std::max(1, size / 1024);
+    auto sampled = size_t{ 0 };
+    for (auto vertex = 0; vertex < size; vertex += step)
+        graph.for_each_neighbor(vertex, [&sampled](int, float) { sampled++; });
+    edges.reserve(sampled * step + sampled * step / 8);
+    auto max_weight = 0.0f;
+    for (auto vertex = 0; vertex < size; vertex++)
+    {
+        graph.for_each_neighbor(vertex, [&](const int to, const float weight)
+        {
+            if (!(weight >= 0) || weight == std::numeric_limits<float>::infinity())
+                throw std::invalid_argument("Delta-stepping needs finite edge weights that are not negative");
+            max_weight = std::max(max_weight, weight);
+            if (weight > delta)
+            {
+                deferred.emplace_back(to, weight);
+                return;
+            }
+            edges.emplace_back(to, weight);
+        });
+        splits[vertex] = static_cast<int>(edges.size());
+        edges.insert(edges.end(), deferred.begin(), deferred.end());
+        deferred.clear();
+        offsets[vertex + 1] = static_cast<int>(edges.size());
+    }
+    if (thread_count <= 0)
+        thread_count = std::max(1, static_cast<int>(std::thread::hardware_concurrency()));
+    const auto reach = std::ceil(static_cast<double>(max_weight) / delta);
+    if (reach >= std::numeric_limits<int>::max())
+        throw std::invalid_argument("The bucket width is too small for the edge weights");
+
+    auto slots = std::vector<std::atomic<uint64_t>>(size);
+    for (auto& slot : slots)
+        slot.store(pack_distance(std::numeric_limits<float>::infinity(), -1), std::memory_order_relaxed);
+    slots[start].store(pack_distance(0, -1), std::memory_order_relaxed);
+    const auto bucket_of = [delta](const float distance) { return static_cast<size_t>(distance / delta); };
+
+    // What the threads work on in the next round, only changed between rounds. Bucket numbers are absolute and live
+    // in the slot of their number modulo the bucket count, one extra slot covers rounding in distance / delta
+    const auto bucket_count = static_cast<size_t>(reach) + 2;
+    auto buckets = std::vector<std::vector<int>>(bucket_count);
+    auto pending = size_t{ 0 };
+    auto current = size_t{ 0 };
+    auto work = std::vector<int>{ start };
+    auto emptied = std::vector<int>{ start };
+    auto heavy = false;
+    auto done = false;
+
+    struct alignas(64) Local
+    {
+        std::vector<int> updated;
+        int scanned = 0;
+    };
+    auto locals = std::vector<Local>(thread_count);
+    // A vertex is in emptied once per bucket, and in work once per round
+    auto emptied_marks = std::vector<size_t>(size, 0);
+    auto round_marks = std::vector<uint32_t>(size, 0);
+    auto round = uint32_t{ 0 };
+    emptied_marks[start] = 1;
+
+    const auto next_round = [&]() noexcept
+    {
+        round++;
+        auto next = std::vector<int>();
+        for (auto& local : locals)
+        {
+            for (const auto vertex : local.updated)
+            {
+                const auto bucket = bucket_of(unpack_distance(slots[vertex].load(std::memory_order_relaxed)));
+                if (bucket == current)
+                {
+                    if (round_marks[vertex] != round)
+                        next.push_back(vertex);
+                    round_marks[vertex] = round;
+                    continue;
+                }
+                buckets[bucket % bucket_count].push_back(vertex);
+                pending++;
+            }
+            local.updated.clear();
+        }
+
+        // Light edges can land in the current bucket, heavy ones only through rounding, either way it gets another round
+        if (!next.empty())
+        {
+            heavy = false;
+            for (const auto vertex : next)
+            {
+                if (emptied_marks[vertex] != current + 1)
+                    emptied.push_back(vertex);
+                emptied_marks[vertex] = current + 1;
+            }
+            work = std::move(next);
+            return;
+        }
+        if (!heavy)
+        {
+            heavy = true;
+            work = emptied;
+            return;
+        }
+
+        // Move on to the next bucket that still has a vertex whose distance belongs in it
+        heavy = false;
+        work.clear();
+        emptied.clear();
+        while (pending > 0)
+        {
+            auto& bucket = buckets[++current % bucket_count];
+            pending -= bucket.size();
+            for (const auto vertex : bucket)
+            {
+                if (emptied_marks[vertex] == current + 1 || bucket_of(unpack_distance(slots[vertex].load(std::memory_order_relaxed))) != current)
+                    continue;
+                emptied_marks[vertex] = current + 1;
+                work.push_back(vertex);
+                emptied.push_back(vertex);
+            }
+            bucket.clear();
+            if (!work.empty())
+                return;
+        }
+        done = true;
+    };
+    auto barrier = std::barrier(thread_count, next_round);
+
+    const auto worker = [&](const int thread)
+    {
+        auto& local = locals[thread];
+        while (!done)
+        {
+            const auto first = work.size() * thread / thread_count;
+            const auto last = work.size() * (thread + 1) / thread_count;
+            for (auto i = first; i < last; i++)
+            {
+                const auto vertex = work[i];
+                const auto first_edge = heavy ? splits[vertex] : offsets[vertex];
+                const auto last_edge = heavy ? offsets[vertex + 1] : splits[vertex];
+                if (first_edge == last_edge)
+                    continue;
+                const auto distance = unpack_distance(slots[vertex].load(std::memory_order_relaxed));
+                local.scanned++;
+                for (auto edge = first_edge; edge < last_edge; edge++)
+                {
+                    // A sum that overflows to infinity is left unreached, it has no bucket
+                    const auto [to, weight] = edges[edge];
+                    const auto computed_distance = distance + weight;
+                    if (computed_distance != std::numeric_limits<float>::infinity() && relax_min(slots[to], pack_distance(computed_distance, vertex)))
+                        local.updated.push_back(to);
+                }
+            }
+            barrier.arrive_and_wait();
+        }
+    };
+
+    {
+        auto threads = std::vector<std::jthread>();
+        for (auto thread = 1; thread < thread_count; thread++)
+            threads.emplace_back(worker, thread);
+        worker(0);
+    }
+
+    auto paths = ShortestPaths(size);
+    for (auto vertex = 0; vertex < size; vertex++)
+    {
+        const auto packed = slots[vertex].load(std::memory_order_relaxed);
+        if (unpack_distance(packed) != std::numeric_limits<float>::infinity())
+            paths.set(vertex, unpack_distance(packed), unpack_predecessor(packed));
+    }
+    for (const auto& local : locals)
+        paths.count_expansion(local.scanned);
+    return paths;
+}
@@ -382,7 +382,17 @@ void Vertex<T>::remove_all_edges()
 {
     for (const auto& edge : this->edges)
     {
-        edge->get_to()->remove_edge(edge);
+        // add_edge gives the other vertex its own edge back, that one has to go as well
+        const auto to = edge->get_to();
+        for (const auto twin : to->edges)
+        {
+            if (to != this && twin->get_to() == this)
+            {
+                to->remove_edge(twin);
+                delete twin;
+                break;
+            }
+        }
         delete edge;
     }
     this->edges.clear();
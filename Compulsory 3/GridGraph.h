@@ -0,0 +1,258 @@
+#pragma once
+#include <array>
+#include <cmath>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+/**
+ * \brief Which cells around a cell are its neighbours.
+ */
+enum class Connectivity
+{
+    Four = 4,
+    Eight = 8
+};
+
+/**
+ * \brief Implicit graph over a heightmap, every cell is a vertex connected to the cells around it.
+ * Neighbours and edge distances are computed from the cell coordinates and heights when asked for, so no edges are stored.
+ * Blocked cells have no edges, and a diagonal step needs both cells beside it to be open so paths never cut corners.
+ * Vertex indexes are x * depth + z.
+ */
+class GridGraph
+{
+    int width;
+    int depth;
+    std::vector<float> heights;
+    std::vector<bool> blocked;
+    Connectivity connectivity;
+    float height_scale;
+
+    // Cardinal directions first, so the first four entries are the 4-connected neighbourhood
+    static constexpr std::array<std::pair<int, int>, 8> directions = { {
+        { 1, 0 }, { -1, 0 }, { 0, 1 }, { 0, -1 },
+        { 1, 1 }, { 1, -1 }, { -1, 1 }, { -1, -1 }
+    } };
+public:
+    /**
+     * \brief Creates a grid graph over a heightmap.
+     * \param width The amount of cells along x.
+     * \param depth The amount of cells along z.
+     * \param heights The height of every cell, at index x * depth + z.
+     * \param connectivity Whether diagonal cells are neighbours.
+     * \param height_scale How much a height difference counts towards the distance compared to a horizontal step.
+     */
+    GridGraph(int width, int depth, std::vector<float> heights, Connectivity connectivity = Connectivity::Eight, float height_scale = 1);
+
+    /**
+     * \brief Calls a function for every neighbour of a cell.
+     * \param vertex The index of the cell.
+     * \param f The function to call with the index of each neighbour and the distance to it.
+     */
+    template <typename Func>
+    void for_each_neighbor(int vertex, Func f) const;
+
+    /**
+     * \brief Gets the distance of a step between two neighbouring cells.
+     * The distance is the length of the step in 3D with the height difference multiplied by the height scale.
+     * \param from The index of the first cell.
+     * \param to The index of the second cell.
+     * \return The distance between the cells.
+     */
+    [[nodiscard]] float get_distance(int from, int to) const;
+
+    /**
+     * \brief Blocks or opens a cell.
+     * \param vertex The index of the cell.
+     * \param blocked True to remove the cell from the graph, false to add it back.
+     */
+    void set_blocked(int vertex, bool blocked);
+
+    /**
+     * \brief Checks if a cell is blocked.
+     * \param vertex The index of the cell.
+     * \return True if the cell is blocked, false otherwise.
+     */
+    [[nodiscard]] bool is_blocked(int vertex) const;
+
+    /**
+     * \brief Checks if a coordinate is inside the grid and not blocked.
+     * \param x The x coordinate.
+     * \param z The z coordinate.
+     * \return True if a path can go through the cell, false otherwise.
+     */
+    [[nodiscard]] bool is_walkable(int x, int z) const;
+
+    /**
+     * \brief Checks if a coordinate is inside the grid.
+     * \param x The x coordinate.
+     * \param z The z coordinate.
+     * \return True if the coordinate is inside the grid, false otherwise.
+     */
+    [[nodiscard]] bool is_inside(int x, int z) const;
+
+    /**
+     * \brief Gets the index of the cell at a coordinate.
+     * \param x The x coordinate.
+     * \param z The z coordinate.
+     * \return The index of the cell.
+     */
+    [[nodiscard]] int get_index(int x, int z) const;
+
+    /**
+     * \brief Gets the x coordinate of a cell.
+     * \param vertex The index of the cell.
+     * \return The x coordinate.
+     */
+    [[nodiscard]] int get_x(int vertex) const;
+
+    /**
+     * \brief Gets the z coordinate of a cell.
+     * \param vertex The index of the cell.
+     * \return The z coordinate.
+     */
+    [[nodiscard]] int get_z(int vertex) const;
+
+    /**
+     * \brief Gets the height of a cell.
+     * \param vertex The index of the cell.
+     * \return The height of the cell.
+     */
+    [[nodiscard]] float get_height(int vertex) const;
+
+    /**
+     * \brief Gets the scale applied to height differences.
+     * \return The height scale.
+     */
+    [[nodiscard]] float get_height_scale() const;
+
+    /**
+     * \brief Gets whether diagonal cells are neighbours.
+     * \return The connectivity of the grid.
+     */
+    [[nodiscard]] Connectivity get_connectivity() const;
+
+    /**
+     * \brief Gets the amount of cells along x.
+     * \return The width of the grid.
+     */
+    [[nodiscard]] int get_width() const;
+
+    /**
+     * \brief Gets the amount of cells along z.
+     * \return The depth of the grid.
+     */
+    [[nodiscard]] int get_depth() const;
+
+    /**
+     * \brief Gets the amount of cells in the grid.
+     * \return The amount of cells in the grid.
+     */
+    [[nodiscard]] int size() const;
+};
+
+inline GridGraph::GridGraph(int width, int depth, std::vector<float> heights, Connectivity connectivity, float height_scale)
+{
+    if (static_cast<int>(heights.size()) != width * depth)
+        throw std::invalid_argument("The heightmap does not have width * depth cells");
+    this->width = width;
+    this->depth = depth;
+    this->heights = std::move(heights);
+    this->blocked = std::vector<bool>(this->heights.size(), false);
+    this->connectivity = connectivity;
+    this->height_scale = height_scale;
+}
+
+template <typename Func>
+void GridGraph::for_each_neighbor(int vertex, Func f) const
+{
+    if (this->blocked[vertex])
+        return;
+    const auto x = vertex / this->depth;
+    const auto z = vertex % this->depth;
+    const auto count = static_cast<int>(this->connectivity);
+    for (auto i = 0; i < count; i++)
+    {
+        const auto [dx, dz] = directions[i];
+        if (!this->is_walkable(x + dx, z + dz))
+            continue;
+        if (dx != 0 && dz != 0 && (!this->is_walkable(x + dx, z) || !this->is_walkable(x, z + dz)))
+            continue;
+        const auto to = vertex + dx * this->depth + dz;
+        f(to, this->get_distance(vertex, to));
+    }
+}
+
+inline float GridGraph::get_distance(int from, int to) const
+{
+    const auto dx = static_cast<float>(this->get_x(to) - this->get_x(from));
+    const auto dz = static_cast<float>(this->get_z(to) - this->get_z(from));
+    const auto dy = (this->heights[to] - this->heights[from]) * this->height_scale;
+    return std::sqrt(dx * dx + dy * dy + dz * dz);
+}
+
+inline void GridGraph::set_blocked(int vertex, bool blocked)
+{
+    this->blocked[vertex] = blocked;
+}
+
+inline bool GridGraph::is_blocked(int vertex) const
+{
+    return this->blocked[vertex];
+}
+
+inline bool GridGraph::is_walkable(int x, int z) const
+{
+    return this->is_inside(x, z) && !this->blocked[x * this->depth + z];
+}
+
+inline bool GridGraph::is_inside(int x, int z) const
+{
+    return x >= 0 && x < this->width && z >= 0 && z < this->depth;
+}
+
+inline int GridGraph::get_index(int x, int z) const
+{
+    return x * this->depth + z;
+}
+
+inline int GridGraph::get_x(int vertex) const
+{
+    return vertex / this->depth;
+}
+
+inline int GridGraph::get_z(int vertex) const
+{
+    return vertex % this->depth;
+}
+
+inline float GridGraph::get_height(int vertex) const
+{
+    return this->heights[vertex];
+}
+
+inline float GridGraph::get_height_scale() const
+{
+    return this->height_scale;
+}
+
+inline Connectivity GridGraph::get_connectivity() const
+{
+    return this->connectivity;
+}
+
+inline int GridGraph::get_width() const
+{
+    return this->width;
+}
+
+inline int GridGraph::get_depth() const
+{
+    return this->depth;
+}
+
+inline int GridGraph::size() const
+{
+    return this->width * this->depth;
+}
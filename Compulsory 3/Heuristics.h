@@ -0,0 +1,138 @@
+#pragma once
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+
+#include "GridGraph.h"
+
+/*
+ * Lower bounds on the distance to a goal cell for A* on a GridGraph.
+ * A step costs sqrt(horizontal^2 + dy^2), so the cost of any path is at least sqrt(H^2 + Y^2) where H is the shortest
+ * horizontal route and Y the total height difference. Each heuristic puts its own horizontal distance in for H,
+ * which keeps it admissible and consistent as long as that horizontal distance is.
+ */
+
+/**
+ * \brief Straight line distance in 3D, admissible for both connectivities.
+ */
+class EuclideanHeuristic
+{
+    const GridGraph* grid;
+    int goal;
+public:
+    /**
+     * \brief Creates the heuristic for a goal cell.
+     * \param grid The grid that is searched.
+     * \param goal The index of the goal cell.
+     */
+    EuclideanHeuristic(const GridGraph& grid, int goal);
+
+    /**
+     * \brief Estimates the distance from a cell to the goal.
+     * \param vertex The index of the cell.
+     * \return A distance that is never above the real one.
+     */
+    float operator()(int vertex) const;
+};
+
+/**
+ * \brief Octile distance with height, the exact distance on flat 8-connected ground. Admissible for both connectivities.
+ */
+class OctileHeuristic
+{
+    const GridGraph* grid;
+    int goal;
+public:
+    /**
+     * \brief Creates the heuristic for a goal cell.
+     * \param grid The grid that is searched.
+     * \param goal The index of the goal cell.
+     */
+    OctileHeuristic(const GridGraph& grid, int goal);
+
+    /**
+     * \brief Estimates the distance from a cell to the goal.
+     * \param vertex The index of the cell.
+     * \return A distance that is never above the real one.
+     */
+    float operator()(int vertex) const;
+};
+
+/**
+ * \brief Manhattan distance with height, the exact distance on flat 4-connected ground.
+ * It overestimates diagonal steps, so it is only admissible on grids with Connectivity::Four.
+ */
+class ManhattanHeuristic
+{
+    const GridGraph* grid;
+    int goal;
+public:
+    /**
+     * \brief Creates the heuristic for a goal cell.
+     * \param grid The grid that is searched.
+     * \param goal The index of the goal cell.
+     */
+    ManhattanHeuristic(const GridGraph& grid, int goal);
+
+    /**
+     * \brief Estimates the distance from a cell to the goal.
+     * \param vertex The index of the cell.
+     * \return A distance that is never above the real one on a 4-connected grid.
+     */
+    float operator()(int vertex) const;
+};
+
+/**
+ * \brief Combines a horizontal lower bound with the height difference between two cells.
+ * \param grid The grid the cells are in.
+ * \param horizontal The lower bound on the horizontal distance.
+ * \param from The index of the first cell.
+ * \param to The index of the second cell.
+ * \return The lower bound on the distance including the height difference.
+ */
+inline float with_height(const GridGraph& grid, const float horizontal, const int from, const int to)
+{
+    const auto dy = (grid.get_height(to) - grid.get_height(from)) * grid.get_height_scale();
+    return std::sqrt(horizontal * horizontal + dy * dy);
+}
+
+inline EuclideanHeuristic::EuclideanHeuristic(const GridGraph& grid, int goal)
+{
+    this->grid = &grid;
+    this->goal = goal;
+}
+
+inline float EuclideanHeuristic::operator()(int vertex) const
+{
+    const auto dx = static_cast<float>(this->grid->get_x(this->goal) - this->grid->get_x(vertex));
+    const auto dz = static_cast<float>(this->grid->get_z(this->goal) - this->grid->get_z(vertex));
+    return with_height(*this->grid, std::sqrt(dx * dx + dz * dz), vertex, this->goal);
+}
+
+inline OctileHeuristic::OctileHeuristic(const GridGraph& grid, int goal)
+{
+    this->grid = &grid;
+    this->goal = goal;
+}
+
+inline float OctileHeuristic::operator()(int vertex) const
+{
+    const auto dx = std::abs(this->grid->get_x(this->goal) - this->grid->get_x(vertex));
+    const auto dz = std::abs(this->grid->get_z(this->goal) - this->grid->get_z(vertex));
+    // Diagonal steps cover the shorter axis, straight steps the rest
+    const auto horizontal = static_cast<float>(std::max(dx, dz)) + (std::sqrt(2.0f) - 1) * static_cast<float>(std::min(dx, dz));
+    return with_height(*this->grid, horizontal, vertex, this->goal);
+}
+
+inline ManhattanHeuristic::ManhattanHeuristic(const GridGraph& grid, int goal)
+{
+    this->grid = &grid;
+    this->goal = goal;
+}
+
+inline float ManhattanHeuristic::operator()(int vertex) const
+{
+    const auto dx = std::abs(this->grid->get_x(this->goal) - this->grid->get_x(vertex));
+    const auto dz = std::abs(this->grid->get_z(this->goal) - this->grid->get_z(vertex));
+    return with_height(*this->grid, static_cast<float>(dx + dz), vertex, this->goal);
+}
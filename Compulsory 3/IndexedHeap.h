@@ -0,0 +1,267 @@
+#pragma once
+#include <functional>
+#include <utility>
+#include <vector>
+
+/**
+ * \brief A d-ary min heap of vertex indexes that supports changing the key of an index already in the heap.
+ * A position map from index to heap slot makes contains and decrease O(1) lookups, so every vertex is in the heap at most once.
+ * \tparam Key The type of the priority.
+ * \tparam Compare Returns true if the first key should be popped before the second.
+ * \tparam Arity The amount of children of every heap node, 4 keeps a parent and its children in one cache line for float keys.
+ */
+template <class Key, class Compare = std::less<Key>, int Arity = 4>
+class IndexedHeap
+{
+    static_assert(Arity >= 2, "A heap needs at least two children per node");
+
+    struct Entry
+    {
+        Key key;
+        int index;
+    };
+
+    std::vector<Entry> heap;
+    std::vector<int> positions;
+    Compare compare;
+
+    void sift_up(int slot);
+    void sift_down(int slot);
+    void place(int slot, Entry entry);
+public:
+    /**
+     * \brief Creates an empty heap for indexes below the given capacity.
+     * \param capacity One more than the largest index that can be pushed.
+     * \param compare The comparison to order keys with.
+     */
+    explicit IndexedHeap(int capacity = 0, Compare compare = Compare());
+
+    /**
+     * \brief Adds an index that is not in the heap yet.
+     * \param index The index to add.
+     * \param key The priority of the index.
+     */
+    void push(int index, Key key);
+
+    /**
+     * \brief Moves an index already in the heap towards the top with a better key.
+     * \param index The index to update.
+     * \param key The new priority, it must not compare worse than the current one.
+     */
+    void decrease(int index, Key key);
+
+    /**
+     * \brief Adds the index, or improves its key if it is already in the heap and the new key is better.
+     * \param index The index to add or update.
+     * \param key The priority of the index.
+     * \return True if the heap changed.
+     */
+    bool push_or_decrease(int index, Key key);
+
+    /**
+     * \brief Removes the index with the best key.
+     * \return The removed index.
+     */
+    int pop();
+
+    /**
+     * \brief Gets the index with the best key.
+     * \return The index at the top of the heap.
+     */
+    [[nodiscard]] int top() const;
+
+    /**
+     * \brief Gets the best key in the heap.
+     * \return The key at the top of the heap.
+     */
+    [[nodiscard]] const Key& top_key() const;
+
+    /**
+     * \brief Gets the key of an index in the heap.
+     * \param index The index to look up, it must be in the heap.
+     * \return The key of the index.
+     */
+    [[nodiscard]] const Key& get_key(int index) const;
+
+    /**
+     * \brief Checks if an index is in the heap.
+     * \param index The index to look for.
+     * \return True if the index is in the heap, false otherwise.
+     */
+    [[nodiscard]] bool contains(int index) const;
+
+    /**
+     * \brief Removes all indexes from the heap, in time proportional to the amount of indexes left in it.
+     */
+    void clear();
+
+    /**
+     * \brief Changes the capacity of the heap and removes all indexes from it.
+     * \param capacity One more than the largest index that can be pushed.
+     */
+    void reset(int capacity);
+
+    /**
+     * \brief Checks if the heap has any indexes.
+     * \return True if the heap has no indexes, false otherwise.
+     */
+    [[nodiscard]] bool is_empty() const;
+
+    /**
+     * \brief Gets the amount of indexes in the heap.
+     * \return The amount of indexes in the heap.
+     */
+    [[nodiscard]] int size() const;
+};
+
+template <class Key, class Compare, int Arity>
+IndexedHeap<Key, Compare, Arity>::IndexedHeap(int capacity, Compare compare) : compare(compare)
+{
+    this->positions = std::vector<int>(capacity, -1);
+}
+
+template <class Key, class Compare, int Arity>
+void IndexedHeap<Key, Compare, Arity>::place(int slot, Entry entry)
+{
+    this->positions[entry.index] = slot;
+    this->heap[slot] = std::move(entry);
+}
+
+template <class Key, class Compare, int Arity>
+void IndexedHeap<Key, Compare, Arity>::sift_up(int slot)
+{
+    // The moving entry is held aside and written once at its final slot
+    auto entry = std::move(this->heap[slot]);
+    while (slot > 0)
+    {
+        const auto parent = (slot - 1) / Arity;
+        if (!this->compare(entry.key, this->heap[parent].key))
+            break;
+        this->place(slot, std::move(this->heap[parent]));
+        slot = parent;
+    }
+    this->place(slot, std::move(entry));
+}
+
+template <class Key, class Compare, int Arity>
+void IndexedHeap<Key, Compare, Arity>::sift_down(int slot)
+{
+    auto entry = std::move(this->heap[slot]);
+    const auto count = static_cast<int>(this->heap.size());
+    while (true)
+    {
+        const auto first = slot * Arity + 1;
+        if (first >= count)
+            break;
+        const auto last = first + Arity < count ? first + Arity : count;
+        auto best = first;
+        for (auto child = first + 1; child < last; child++)
+        {
+            if (this->compare(this->heap[child].key, this->heap[best].key))
+                best = child;
+        }
+        if (!this->compare(this->heap[best].key, entry.key))
+            break;
+        this->place(slot, std::move(this->heap[best]));
+        slot = best;
+    }
+    this->place(slot, std::move(entry));
+}
+
+template <class Key, class Compare, int Arity>
+void IndexedHeap<Key, Compare, Arity>::push(int index, Key key)
+{
+    this->heap.push_back({ std::move(key), index });
+    this->sift_up(static_cast<int>(this->heap.size()) - 1);
+}
+
+template <class Key, class Compare, int Arity>
+void IndexedHeap<Key, Compare, Arity>::decrease(int index, Key key)
+{
+    const auto slot = this->positions[index];
+    this->heap[slot].key = std::move(key);
+    this->sift_up(slot);
+}
+
+template <class Key, class Compare, int Arity>
+bool IndexedHeap<Key, Compare, Arity>::push_or_decrease(int index, Key key)
+{
+    if (!this->contains(index))
+    {
+        this->push(index, std::move(key));
+        return true;
+    }
+    if (!this->compare(key, this->get_key(index)))
+        return false;
+    this->decrease(index, std::move(key));
+    return true;
+}
+
+template <class Key, class Compare, int Arity>
+int IndexedHeap<Key, Compare, Arity>::pop()
+{
+    const auto index = this->heap.front().index;
+    this->positions[index] = -1;
+    if (this->heap.size() > 1)
+    {
+        this->heap.front() = std::move(this->heap.back());
+        this->heap.pop_back();
+        this->sift_down(0);
+    }
+    else
+    {
+        this->heap.pop_back();
+    }
+    return index;
+}
+
+template <class Key, class Compare, int Arity>
+int IndexedHeap<Key, Compare, Arity>::top() const
+{
+    return this->heap.front().index;
+}
+
+template <class Key, class Compare, int Arity>
+const Key& IndexedHeap<Key, Compare, Arity>::top_key() const
+{
+    return this->heap.front().key;
+}
+
+template <class Key, class Compare, int Arity>
+const Key& IndexedHeap<Key, Compare, Arity>::get_key(int index) const
+{
+    return this->heap[this->positions[index]].key;
+}
+
+template <class Key, class Compare, int Arity>
+bool IndexedHeap<Key, Compare, Arity>::contains(int index) const
+{
+    return this->positions[index] >= 0;
+}
+
+template <class Key, class Compare, int Arity>
+void IndexedHeap<Key, Compare, Arity>::clear()
+{
+    for (const auto& entry : this->heap)
+        this->positions[entry.index] = -1;
+    this->heap.clear();
+}
+
+template <class Key, class Compare, int Arity>
+void IndexedHeap<Key, Compare, Arity>::reset(int capacity)
+{
+    this->heap.clear();
+    this->positions.assign(capacity, -1);
+}
+
+template <class Key, class Compare, int Arity>
+bool IndexedHeap<Key, Compare, Arity>::is_empty() const
+{
+    return this->heap.empty();
+}
+
+template <class Key, class Compare, int Arity>
+int IndexedHeap<Key, Compare, Arity>::size() const
+{
+    return static_cast<int>(this->heap.size());
+}
@@ -0,0 +1,336 @@
+#pragma once
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdlib>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+#include "GridGraph.h"
+#include "IndexedHeap.h"
+#include "PathFinding.h"
+
+/*
+ * Jump point search only pushes the cells where an optimal path may have to turn, found by "jumping" in a straight or
+ * diagonal line until something around the line forces a decision. It relies on every straight step costing 1 and every
+ * diagonal step sqrt(2), so it needs a GridGraph with Connectivity::Eight and a height scale of 0, with obstacles given
+ * as blocked cells. Paths never cut corners, the same rule GridGraph::for_each_neighbor follows.
+ */
+
+/**
+ * \brief The eight directions of travel, ordered around the circle so neighbouring entries are 45 degrees apart.
+ * Even entries are straight and odd entries diagonal.
+ */
+inline constexpr std::array<std::pair<int, int>, 8> jump_directions = { {
+    { 1, 0 }, { 1, 1 }, { 0, 1 }, { -1, 1 },
+    { -1, 0 }, { -1, -1 }, { 0, -1 }, { 1, -1 }
+} };
+
+/**
+ * \brief Gets the distance between two cells on a flat 8-connected grid without obstacles.
+ * \param grid The grid the cells are in.
+ * \param from The index of the first cell.
+ * \param to The index of the second cell.
+ * \return The octile distance between the cells.
+ */
+inline float octile_distance(const GridGraph& grid, const int from, const int to)
+{
+    const auto dx = std::abs(grid.get_x(to) - grid.get_x(from));
+    const auto dz = std::abs(grid.get_z(to) - grid.get_z(from));
+    return static_cast<float>(std::max(dx, dz)) + (std::sqrt(2.0f) - 1) * static_cast<float>(std::min(dx, dz));
+}
+
+/**
+ * \brief Checks if a cell entered in a straight line has a neighbour that can only be reached optimally through it.
+ * Without corner cutting that is an open cell beside it whose cell behind it is blocked.
+ * \param grid The grid the cell is in.
+ * \param x The x coordinate of the cell.
+ * \param z The z coordinate of the cell.
+ * \param dx The x direction of travel.
+ * \param dz The z direction of travel, 0 if dx is not.
+ * \return True if the cell is a jump point for this direction.
+ */
+inline bool has_forced_neighbor(const GridGraph& grid, const int x, const int z, const int dx, const int dz)
+{
+    if (dx != 0)
+        return (grid.is_walkable(x, z + 1) && !grid.is_walkable(x - dx, z + 1)) || (grid.is_walkable(x, z - 1) && !grid.is_walkable(x - dx, z - 1));
+    return (grid.is_walkable(x + 1, z) && !grid.is_walkable(x + 1, z - dz)) || (grid.is_walkable(x - 1, z) && !grid.is_walkable(x - 1, z - dz));
+}
+
+/**
+ * \brief Runs A* over jump points, the searches only differ in how they find the next jump point in a direction.
+ * \tparam Jump Callable that takes a cell and a direction index and returns the next jump point or -1.
+ * \param grid The grid to search.
+ * \param start The index of the starting cell.
+ * \param goal The index of the goal cell.
+ * \param jump The jump function.
+ * \return The shortest path to the goal with every cell on it filled in, other cells only hold jump points.
+ */
+template <typename Jump>
+ShortestPaths search_jump_points(const GridGraph& grid, const int start, const int goal, Jump jump)
+{
+    if (grid.get_connectivity() != Connectivity::Eight || grid.get_height_scale() != 0)
+        throw std::invalid_argument("Jump point search needs a flat 8-connected grid");
+
+    // Direction index of a step by its signs, (dx + 1) * 3 + dz + 1
+    static constexpr std::array<int, 9> direction_index = { 5, 4, 3, 6, -1, 2, 7, 0, 1 };
+    const auto direction_of = [&grid](const int from, const int to)
+    {
+        const auto dx = grid.get_x(to) - grid.get_x(from);
+        const auto dz = grid.get_z(to) - grid.get_z(from);
+        return direction_index[((dx > 0) - (dx < 0) + 1) * 3 + (dz > 0) - (dz < 0) + 1];
+    };
+
+    auto paths = ShortestPaths(grid.size());
+    auto closed = std::vector<bool>(grid.size(), false);
+    auto open = IndexedHeap<AStarKey>(grid.size());
+    paths.set(start, 0, -1);
+    // The jumps only look at the cells they land on, so a blocked start would otherwise leave through its walls
+    if (grid.is_blocked(start) || grid.is_blocked(goal))
+        return paths;
+    open.push(start, { octile_distance(grid, start, goal), 0 });
+    while (!open.is_empty())
+    {
+        const auto vertex = open.pop();
+        closed[vertex] = true;
+        paths.count_expansion();
+        if (vertex == goal)
+            break;
+
+        // The start looks everywhere, a straight arrival looks ahead, to the sides and diagonally forward,
+        // and a diagonal arrival only along the diagonal and its two straight parts
+        const auto predecessor = paths.get_predecessor(vertex);
+        auto first = 0;
+        auto last = 7;
+        if (predecessor != -1)
+        {
+            const auto travel = direction_of(predecessor, vertex);
+            const auto spread = travel % 2 == 0 ? 2 : 1;
+            first = travel - spread;
+            last = travel + spread;
+        }
+        const auto distance = paths.get_distance(vertex);
+        for (auto i = first; i <= last; i++)
+        {
+            const auto to = jump(vertex, (i + 8) % 8);
+            if (to == -1 || closed[to])
+                continue;
+            const auto computed_distance = distance + octile_distance(grid, vertex, to);
+            if (computed_distance >= paths.get_distance(to))
+                continue;
+            paths.set(to, computed_distance, vertex);
+            open.push_or_decrease(to, { computed_distance + octile_distance(grid, to, goal), computed_distance });
+        }
+    }
+
+    // Jump points are joined by straight or diagonal lines, the cells on them get their predecessors here
+    for (auto vertex = goal; paths.is_reached(vertex) && paths.get_predecessor(vertex) != -1;)
+    {
+        const auto from = paths.get_predecessor(vertex);
+        const auto [dx, dz] = jump_directions[direction_of(from, vertex)];
+        const auto step = grid.get_index(dx, dz);
+        const auto step_distance = dx != 0 && dz != 0 ? std::sqrt(2.0f) : 1.0f;
+        auto previous = from;
+        auto cell_distance = paths.get_distance(from);
+        for (auto cell = from + step; cell != vertex; cell += step)
+        {
+            cell_distance += step_distance;
+            paths.set(cell, cell_distance, previous);
+            previous = cell;
+        }
+        paths.set(vertex, paths.get_distance(vertex), previous);
+        vertex = from;
+    }
+    return paths;
+}
+
+/**
+ * \brief Jump point search that finds jump points by scanning the grid during the search.
+ */
+class JumpPointSearch
+{
+    const GridGraph* grid;
+
+    int jump_straight(int x, int z, int dx, int dz, int goal) const;
+    int jump_diagonal(int x, int z, int dx, int dz, int goal) const;
+public:
+    /**
+     * \brief Creates a search over a grid.
+     * \param grid The flat 8-connected grid to search.
+     */
+    explicit JumpPointSearch(const GridGraph& grid);
+
+    /**
+     * \brief Finds the shortest path between two cells.
+     * \param start The index of the starting cell.
+     * \param goal The index of the goal cell.
+     * \return The shortest path to the goal.
+     */
+    [[nodiscard]] ShortestPaths search(int start, int goal) const;
+};
+
+/**
+ * \brief Jump point search with the jump distances of every cell in every direction computed up front (JPS+).
+ * A positive distance is the amount of steps to the next jump point, zero or a negative distance is the amount of open
+ * steps before a wall. The table is not updated when cells of the grid are blocked or opened afterwards.
+ */
+class JumpPointTable
+{
+    const GridGraph* grid;
+    std::vector<std::array<int, 8>> distances;
+
+    int jump(int vertex, int direction, int goal) const;
+public:
+    /**
+     * \brief Computes the jump distances of a grid, in time proportional to the amount of cells.
+     * \param grid The flat 8-connected grid to search.
+     */
+    explicit JumpPointTable(const GridGraph& grid);
+
+    /**
+     * \brief Gets the jump distance of a cell in a direction.
+     * \param vertex The index of the cell.
+     * \param direction The index of the direction in jump_directions.
+     * \return Steps to the next jump point if positive, otherwise minus the open steps before a wall.
+     */
+    [[nodiscard]] int get_jump_distance(int vertex, int direction) const;
+
+    /**
+     * \brief Finds the shortest path between two cells.
+     * \param start The index of the starting cell.
+     * \param goal The index of the goal cell.
+     * \return The shortest path to the goal.
+     */
+    [[nodiscard]] ShortestPaths search(int start, int goal) const;
+};
+
+inline JumpPointSearch::JumpPointSearch(const GridGraph& grid)
+{
+    this->grid = &grid;
+}
+
+inline int JumpPointSearch::jump_straight(int x, int z, const int dx, const int dz, const int goal) const
+{
+    while (true)
+    {
+        x += dx;
+        z += dz;
+        if (!this->grid->is_walkable(x, z))
+            return -1;
+        const auto vertex = this->grid->get_index(x, z);
+        if (vertex == goal || has_forced_neighbor(*this->grid, x, z, dx, dz))
+            return vertex;
+    }
+}
+
+inline int JumpPointSearch::jump_diagonal(int x, int z, const int dx, const int dz, const int goal) const
+{
+    while (true)
+    {
+        if (!this->grid->is_walkable(x + dx, z + dz) || !this->grid->is_walkable(x + dx, z) || !this->grid->is_walkable(x, z + dz))
+            return -1;
+        x += dx;
+        z += dz;
+        const auto vertex = this->grid->get_index(x, z);
+        // A diagonal stops where one of its straight parts leads somewhere
+        if (vertex == goal || this->jump_straight(x, z, dx, 0, goal) != -1 || this->jump_straight(x, z, 0, dz, goal) != -1)
+            return vertex;
+    }
+}
+
+inline ShortestPaths JumpPointSearch::search(const int start, const int goal) const
+{
+    return search_jump_points(*this->grid, start, goal, [this, goal](const int vertex, const int direction)
+    {
+        const auto [dx, dz] = jump_directions[direction];
+        const auto x = this->grid->get_x(vertex);
+        const auto z = this->grid->get_z(vertex);
+        return direction % 2 == 0 ? this->jump_straight(x, z, dx, dz, goal) : this->jump_diagonal(x, z, dx, dz, goal);
+    });
+}
+
+inline JumpPointTable::JumpPointTable(const GridGraph& grid)
+{
+    if (grid.get_connectivity() != Connectivity::Eight || grid.get_height_scale() != 0)
+        throw std::invalid_argument("Jump point search needs a flat 8-connected grid");
+    this->grid = &grid;
+    this->distances = std::vector<std::array<int, 8>>(grid.size(), std::array<int, 8>{});
+
+    // Every direction is swept from the far side so the next cell along it is always done first,
+    // and the straight directions go before the diagonals that depend on them
+    for (const auto pass : { 0, 1 })
+    {
+        for (auto direction = pass; direction < 8; direction += 2)
+        {
+            const auto [dx, dz] = jump_directions[direction];
+            for (auto i = 0; i < grid.get_width(); i++)
+            {
+                const auto x = dx > 0 ? grid.get_width() - 1 - i : i;
+                for (auto j = 0; j < grid.get_depth(); j++)
+                {
+                    const auto z = dz > 0 ? grid.get_depth() - 1 - j : j;
+                    if (!grid.is_walkable(x, z))
+                        continue;
+                    auto& distance = this->distances[grid.get_index(x, z)][direction];
+                    const auto diagonal = direction % 2 == 1;
+                    if (!grid.is_walkable(x + dx, z + dz) || (diagonal && (!grid.is_walkable(x + dx, z) || !grid.is_walkable(x, z + dz))))
+                    {
+                        distance = 0;
+                        continue;
+                    }
+                    const auto& next = this->distances[grid.get_index(x + dx, z + dz)];
+                    const auto is_jump_point = diagonal
+                        ? next[direction - 1] > 0 || next[(direction + 1) % 8] > 0
+                        : has_forced_neighbor(grid, x + dx, z + dz, dx, dz);
+                    if (is_jump_point)
+                        distance = 1;
+                    else
+                        distance = next[direction] > 0 ? next[direction] + 1 : next[direction] - 1;
+                }
+            }
+        }
+    }
+}
+
+inline int JumpPointTable::jump(const int vertex, const int direction, const int goal) const
+{
+    const auto distance = this->distances[vertex][direction];
+    const auto [dx, dz] = jump_directions[direction];
+    const auto x = this->grid->get_x(vertex);
+    const auto z = this->grid->get_z(vertex);
+    const auto goal_dx = this->grid->get_x(goal) - x;
+    const auto goal_dz = this->grid->get_z(goal) - z;
+    const auto reach = std::abs(distance);
+
+    // The goal is not a jump point in the table, a line that passes it or lines up with it stops there instead
+    if (direction % 2 == 0)
+    {
+        const auto along = dx != 0 ? goal_dx * dx : goal_dz * dz;
+        const auto across = dx != 0 ? goal_dz : goal_dx;
+        if (across == 0 && along > 0 && along <= reach)
+            return goal;
+    }
+    else if (goal_dx * dx > 0 && goal_dz * dz > 0)
+    {
+        const auto steps = std::min(std::abs(goal_dx), std::abs(goal_dz));
+        if (steps <= reach)
+            return this->grid->get_index(x + dx * steps, z + dz * steps);
+    }
+    if (distance <= 0)
+        return -1;
+    return this->grid->get_index(x + dx * distance, z + dz * distance);
+}
+
+inline int JumpPointTable::get_jump_distance(const int vertex, const int direction) const
+{
+    return this->distances[vertex][direction];
+}
+
+inline ShortestPaths JumpPointTable::search(const int start, const int goal) const
+{
+    return search_jump_points(*this->grid, start, goal, [this, goal](const int vertex, const int direction)
+    {
+        return this->jump(vertex, direction, goal);
+    });
+}
@@ -0,0 +1,257 @@
+#pragma once
+#include <algorithm>
+#include <limits>
+#include <random>
+#include <vector>
+
+#include "PathFinding.h"
+
+/**
+ * \brief How the landmark vertexes are picked.
+ */
+enum class LandmarkSelection
+{
+    /**
+     * \brief Every new landmark is the vertex furthest from the landmarks picked so far.
+     */
+    Farthest,
+    /**
+     * \brief Every new landmark is a leaf of the shortest path tree from a random root, in the subtree where the
+     * current landmarks give the worst lower bounds. Slower to pick, but usually gives tighter bounds.
+     */
+    Avoid
+};
+
+/**
+ * \brief Precomputed distances to and from a few landmark vertexes, for A* on graphs without coordinates (ALT).
+ * By the triangle inequality d(v, t) >= d(L, t) - d(L, v) and d(v, t) >= d(v, L) - d(t, L) for every landmark L,
+ * and the largest of these is a consistent lower bound. The distances are stored per vertex, so a bound reads two
+ * short rows of landmark_count floats.
+ */
+class Landmarks
+{
+    std::vector<int> landmarks;
+    int vertex_count;
+    int landmark_count;
+    // d(L, v) and d(v, L) at vertex * landmark_count + landmark
+    std::vector<float> from_landmark;
+    std::vector<float> to_landmark;
+
+    template <class Forward, class Backward>
+    void add(const Forward& forward, const Backward& backward, int vertex);
+    [[nodiscard]] int pick_farthest() const;
+    template <class Forward>
+    [[nodiscard]] int pick_avoid(const Forward& forward, int root) const;
+public:
+    /**
+     * \brief Picks the landmarks and computes the distances with two full Dijkstra searches per landmark.
+     * \tparam Forward The type of the graph, it needs size() and for_each_neighbor(vertex, f).
+     * \tparam Backward The type of the reversed graph, it needs size() and for_each_neighbor(vertex, f).
+     * \param forward The graph to compute the bounds for.
+     * \param backward The graph with every edge reversed, the same graph if every edge goes both ways.
+     * \param count The amount of landmarks, more give tighter bounds but use more memory and time per bound.
+     * \param selection How the landmarks are picked.
+     * \param seed The seed for the random vertexes the selection starts from.
+     */
+    template <class Forward, class Backward>
+    Landmarks(const Forward& forward, const Backward& backward, int count, LandmarkSelection selection = LandmarkSelection::Avoid, unsigned seed = 0);
+
+    /**
+     * \brief Gets a lower bound on the distance between two vertexes.
+     * \param from The index of the first vertex.
+     * \param to The index of the second vertex.
+     * \return A distance that is never above the real one, infinity if a landmark shows there is no path.
+     */
+    [[nodiscard]] float lower_bound(int from, int to) const;
+
+    /**
+     * \brief Gets the vertexes that were picked as landmarks.
+     * \return The indexes of the landmarks.
+     */
+    [[nodiscard]] const std::vector<int>& get_landmarks() const;
+
+    /**
+     * \brief Gets the amount of vertexes in the graph.
+     * \return The amount of vertexes in the graph.
+     */
+    [[nodiscard]] int size() const;
+};
+
+/**
+ * \brief Landmark lower bound on the distance to a goal, for astar on any graph.
+ */
+class LandmarkHeuristic
+{
+    const Landmarks* landmarks;
+    int goal;
+public:
+    /**
+     * \brief Creates the heuristic for a goal vertex.
+     * \param landmarks The landmarks of the graph that is searched.
+     * \param goal The index of the goal vertex.
+     */
+    LandmarkHeuristic(const Landmarks& landmarks, int goal);
+
+    /**
+     * \brief Estimates the distance from a vertex to the goal.
+     * \param vertex The index of the vertex.
+     * \return A distance that is never above the real one.
+     */
+    float operator()(int vertex) const;
+};
+
+template <class Forward, class Backward>
+Landmarks::Landmarks(const Forward& forward, const Backward& backward, int count, LandmarkSelection selection, unsigned seed)
+{
+    const auto size = forward.size();
+    this->vertex_count = size;
+    this->landmark_count = std::min(count, size);
+    this->from_landmark = std::vector<float>(static_cast<size_t>(size) * this->landmark_count, std::numeric_limits<float>::infinity());
+    this->to_landmark = std::vector<float>(static_cast<size_t>(size) * this->landmark_count, std::numeric_limits<float>::infinity());
+    if (this->landmark_count == 0)
+        return;
+
+    auto random = std::mt19937(seed);
+    auto vertexes = std::uniform_int_distribution(0, size - 1);
+
+    // The first landmark is the vertex furthest from a random one, so it sits at the edge of the graph
+    const auto paths = dijkstra(forward, vertexes(random));
+    auto first = 0;
+    for (auto vertex = 1; vertex < size; vertex++)
+    {
+        if (paths.is_reached(vertex) && paths.get_distance(vertex) > paths.get_distance(first))
+            first = vertex;
+    }
+    this->add(forward, backward, first);
+
+    while (static_cast<int>(this->landmarks.size()) < this->landmark_count)
+    {
+        auto next = selection == LandmarkSelection::Avoid ? this->pick_avoid(forward, vertexes(random)) : -1;
+        if (next == -1)
+            next = this->pick_farthest();
+        this->add(forward, backward, next);
+    }
+}
+
+template <class Forward, class Backward>
+void Landmarks::add(const Forward& forward, const Backward& backward, int vertex)
+{
+    const auto landmark = static_cast<int>(this->landmarks.size());
+    this->landmarks.push_back(vertex);
+    const auto from = dijkstra(forward, vertex);
+    const auto to = dijkstra(backward, vertex);
+    for (auto i = 0; i < this->size(); i++)
+    {
+        this->from_landmark[static_cast<size_t>(i) * this->landmark_count + landmark] = from.get_distance(i);
+        this->to_landmark[static_cast<size_t>(i) * this->landmark_count + landmark] = to.get_distance(i);
+    }
+}
+
+inline int Landmarks::pick_farthest() const
+{
+    // The vertex whose closest landmark is furthest away, a vertex no landmark reaches counts as infinitely far
+    const auto picked = static_cast<int>(this->landmarks.size());
+    auto best = -1;
+    auto best_distance = -1.0f;
+    for (auto vertex = 0; vertex < this->size(); vertex++)
+    {
+        const auto row = this->from_landmark.begin() + static_cast<ptrdiff_t>(vertex) * this->landmark_count;
+        const auto closest = *std::min_element(row, row + picked);
+        if (closest > best_distance && std::ranges::find(this->landmarks, vertex) == this->landmarks.end())
+        {
+            best = vertex;
+            best_distance = closest;
+        }
+    }
+    return best;
+}
+
+template <class Forward>
+int Landmarks::pick_avoid(const Forward& forward, int root) const
+{
+    // Every vertex weighs how much the current bound from the root underestimates its distance
+    const auto paths = dijkstra(forward, root);
+    auto children = std::vector<std::vector<int>>(this->size());
+    for (auto vertex = 0; vertex < this->size(); vertex++)
+    {
+        if (paths.get_predecessor(vertex) != -1)
+            children[paths.get_predecessor(vertex)].push_back(vertex);
+    }
+    auto order = std::vector<int>{ root };
+    for (size_t i = 0; i < order.size(); i++)
+        order.insert(order.end(), children[order[i]].begin(), children[order[i]].end());
+
+    // Subtree sums from the leaves up, a subtree with a landmark in it is already covered and counts as 0
+    auto sizes = std::vector<float>(this->size(), 0.0f);
+    auto covered = std::vector<bool>(this->size(), false);
+    for (const auto landmark : this->landmarks)
+        covered[landmark] = true;
+    for (auto it = order.rbegin(); it != order.rend(); ++it)
+    {
+        const auto vertex = *it;
+        sizes[vertex] += paths.get_distance(vertex) - this->lower_bound(root, vertex);
+        const auto parent = paths.get_predecessor(vertex);
+        if (parent == -1)
+            continue;
+        covered[parent] = covered[parent] || covered[vertex];
+        sizes[parent] += sizes[vertex];
+    }
+    for (const auto vertex : order)
+    {
+        if (covered[vertex])
+            sizes[vertex] = 0;
+    }
+
+    auto vertex = *std::ranges::max_element(order, [&sizes](const int a, const int b) { return sizes[a] < sizes[b]; });
+    if (sizes[vertex] <= 0)
+        return -1;
+    // Walk down the heaviest children to a leaf
+    while (true)
+    {
+        const auto& next = children[vertex];
+        const auto heaviest = std::ranges::max_element(next, [&sizes](const int a, const int b) { return sizes[a] < sizes[b]; });
+        if (heaviest == next.end() || sizes[*heaviest] <= 0)
+            return vertex;
+        vertex = *heaviest;
+    }
+}
+
+inline float Landmarks::lower_bound(int from, int to) const
+{
+    const auto picked = static_cast<int>(this->landmarks.size());
+    const auto from_row = static_cast<size_t>(from) * this->landmark_count;
+    const auto to_row = static_cast<size_t>(to) * this->landmark_count;
+    auto bound = 0.0f;
+    for (auto i = 0; i < picked; i++)
+    {
+        // When both distances are infinite the difference is NaN, which fails both comparisons and is skipped
+        const auto ahead = this->from_landmark[to_row + i] - this->from_landmark[from_row + i];
+        const auto behind = this->to_landmark[from_row + i] - this->to_landmark[to_row + i];
+        if (ahead > bound)
+            bound = ahead;
+        if (behind > bound)
+            bound = behind;
+    }
+    return bound;
+}
+
+inline const std::vector<int>& Landmarks::get_landmarks() const
+{
+    return this->landmarks;
+}
+
+inline int Landmarks::size() const
+{
+    return this->vertex_count;
+}
+
+inline LandmarkHeuristic::LandmarkHeuristic(const Landmarks& landmarks, int goal)
+{
+    this->landmarks = &landmarks;
+    this->goal = goal;
+}
+
+inline float LandmarkHeuristic::operator()(int vertex) const
+{
+    return this->landmarks->lower_bound(vertex, this->goal);
+}
@@ -0,0 +1,398 @@
+#pragma once
+#include <limits>
+#include <span>
+#include <stdexcept>
+#include <vector>
+
+#include "IndexedHeap.h"
+
+/**
+ * \brief The result of a search, the distance and the previous vertex on the shortest known path to every vertex.
+ * Paths are recovered by following predecessors back from the goal, so no tree has to be built during the search.
+ */
+class ShortestPaths
+{
+    std::vector<float> distances;
+    std::vector<int> predecessors;
+    int expanded = 0;
+    int reopened = 0;
+public:
+    /**
+     * \brief Creates a result where no vertex has been reached.
+     * \param size The amount of vertexes in the searched graph.
+     */
+    explicit ShortestPaths(int size = 0);
+
+    /**
+     * \brief Records the shortest known path to a vertex.
+     * \param vertex The index of the vertex.
+     * \param distance The length of the path.
+     * \param predecessor The vertex before it on the path, -1 for the start.
+     */
+    void set(int vertex, float distance, int predecessor);
+
+    /**
+     * \brief Gets the length of the shortest known path to a vertex.
+     * \param vertex The index of the vertex.
+     * \return The length of the path, infinity if the vertex was not reached.
+     */
+    [[nodiscard]] float get_distance(int vertex) const;
+
+    /**
+     * \brief Gets the vertex before a vertex on its shortest known path.
+     * \param vertex The index of the vertex.
+     * \return The index of the previous vertex, -1 for the start or a vertex that was not reached.
+     */
+    [[nodiscard]] int get_predecessor(int vertex) const;
+
+    /**
+     * \brief Checks if the search reached a vertex.
+     * \param vertex The index of the vertex.
+     * \return True if there is a known path to the vertex, false otherwise.
+     */
+    [[nodiscard]] bool is_reached(int vertex) const;
+
+    /**
+     * \brief Gets the amount of vertexes on the path to a vertex, both ends included.
+     * \param goal The index of the last vertex on the path.
+     * \return The amount of vertexes on the path, 0 if the goal was not reached.
+     */
+    [[nodiscard]] int path_length(int goal) const;
+
+    /**
+     * \brief Writes the path from the start to a vertex into a buffer, in time proportional to the length of the path.
+     * \param goal The index of the last vertex on the path.
+     * \param output The buffer to write the path to, it has to fit path_length(goal) vertexes.
+     * \return The part of the buffer that holds the path, empty if the goal was not reached.
+     */
+    std::span<int> extract_path(int goal, std::span<int> output) const;
+
+    /**
+     * \brief Counts vertexes taken from the queue and expanded by the search.
+     * \param count The amount of expanded vertexes.
+     */
+    void count_expansion(int count = 1);
+
+    /**
+     * \brief Gets the amount of vertexes the search expanded.
+     * \return The amount of expansions, a vertex that was reopened counts every time.
+     */
+    [[nodiscard]] int get_expanded() const;
+
+    /**
+     * \brief Counts a closed vertex that was reached by a shorter path and has to be expanded again.
+     */
+    void count_reopening();
+
+    /**
+     * \brief Gets the amount of times a closed vertex was opened again, always 0 with a consistent heuristic.
+     * \return The amount of reopened vertexes.
+     */
+    [[nodiscard]] int get_reopened() const;
+
+    /**
+     * \brief Gets the amount of vertexes in the searched graph.
+     * \return The amount of vertexes in the searched graph.
+     */
+    [[nodiscard]] int size() const;
+};
+
+/**
+ * \brief The priority of a vertex in A*.
+ */
+struct AStarKey
+{
+    /**
+     * \brief The length of the path to the vertex plus the estimate to the goal.
+     */
+    float f;
+    /**
+     * \brief The length of the path to the vertex.
+     */
+    float g;
+
+    /**
+     * \brief Orders by f, and on equal f the vertex further from the start first since it is likely closer to the goal.
+     */
+    bool operator<(const AStarKey& other) const
+    {
+        return f < other.f || (f == other.f && g > other.g);
+    }
+};
+
+/**
+ * \brief Finds the shortest paths from a vertex with Dijkstra's algorithm.
+ * \tparam G The type of the graph, it needs size() and for_each_neighbor(vertex, f).
+ * \param graph The graph to search.
+ * \param start The index of the starting vertex.
+ * \param goal The index of the vertex to stop at, -1 to find the paths to every vertex.
+ * \return The shortest paths, final for every vertex that was settled before the goal.
+ */
+template <class G>
+ShortestPaths dijkstra(const G& graph, const int start, const int goal = -1)
+{
+    auto paths = ShortestPaths(graph.size());
+    auto settled = std::vector<bool>(graph.size(), false);
+    auto process = IndexedHeap<float>(graph.size());
+    paths.set(start, 0, -1);
+    process.push(start, 0);
+    while (!process.is_empty())
+    {
+        const auto vertex = process.pop();
+        const auto distance = paths.get_distance(vertex);
+        settled[vertex] = true;
+        paths.count_expansion();
+        if (vertex == goal)
+            break;
+        graph.for_each_neighbor(vertex, [&](const int to, const float weight)
+        {
+            const auto computed_distance = distance + weight;
+            if (settled[to] || computed_distance >= paths.get_distance(to))
+                return;
+            paths.set(to, computed_distance, vertex);
+            process.push_or_decrease(to, computed_distance);
+        });
+    }
+    return paths;
+}
+
+/**
+ * \brief Finds the shortest path between two vertexes with A*.
+ * Vertexes are expanded in order of f = g + h. A closed vertex that is reached by a shorter path is opened again,
+ * which only happens when the heuristic is admissible but not consistent, so the path stays optimal either way.
+ * \tparam G The type of the graph, it needs size() and for_each_neighbor(vertex, f).
+ * \tparam Heuristic Callable that returns a lower bound on the distance from a vertex to the goal.
+ * \param graph The graph to search.
+ * \param start The index of the starting vertex.
+ * \param goal The index of the goal vertex.
+ * \param heuristic The lower bound to guide the search with.
+ * \return The shortest path to the goal, and the paths found to the other vertexes on the way.
+ */
+template <class G, class Heuristic>
+ShortestPaths astar(const G& graph, const int start, const int goal, Heuristic heuristic)
+{
+    auto paths = ShortestPaths(graph.size());
+    auto closed = std::vector<bool>(graph.size(), false);
+    auto open = IndexedHeap<AStarKey>(graph.size());
+    paths.set(start, 0, -1);
+    open.push(start, { heuristic(start), 0 });
+    while (!open.is_empty())
+    {
+        const auto vertex = open.pop();
+        closed[vertex] = true;
+        paths.count_expansion();
+        if (vertex == goal)
+            break;
+        const auto distance = paths.get_distance(vertex);
+        graph.for_each_neighbor(vertex, [&](const int to, const float weight)
+        {
+            const auto computed_distance = distance + weight;
+            if (computed_distance >= paths.get_distance(to))
+                return;
+            // An infinite estimate means the goal can not be reached from there
+            const auto estimate = heuristic(to);
+            if (estimate == std::numeric_limits<float>::infinity())
+                return;
+            if (closed[to])
+            {
+                closed[to] = false;
+                paths.count_reopening();
+            }
+            paths.set(to, computed_distance, vertex);
+            open.push_or_decrease(to, { computed_distance + estimate, computed_distance });
+        });
+    }
+    return paths;
+}
+
+/**
+ * \brief Searches from the start and the goal at the same time, always advancing the side with the smaller queue.
+ * Both searches order vertexes by distance plus a potential, forward by d(v) + potential(v) and backward by
+ * d(v) - potential(v). The best connection mu found so far is optimal once the two smallest keys add up to at least mu.
+ * \tparam G The type of the graphs, it needs size() and for_each_neighbor(vertex, f).
+ * \tparam Potential Callable that returns the potential of a vertex.
+ * \param forward The graph to search from the start.
+ * \param backward The graph with every edge reversed, to search from the goal.
+ * \param start The index of the starting vertex.
+ * \param goal The index of the goal vertex.
+ * \param potential The potential, it has to be consistent in both directions.
+ * \return The shortest path to the goal, with the expansions of both searches counted.
+ */
+template <class G, class Potential>
+ShortestPaths bidirectional_search(const G& forward, const G& backward, const int start, const int goal, Potential potential)
+{
+    auto paths = ShortestPaths(forward.size());
+    auto reverse = ShortestPaths(backward.size());
+    auto forward_settled = std::vector<bool>(forward.size(), false);
+    auto backward_settled = std::vector<bool>(backward.size(), false);
+    auto forward_open = IndexedHeap<float>(forward.size());
+    auto backward_open = IndexedHeap<float>(backward.size());
+    auto best = start == goal ? 0.0f : std::numeric_limits<float>::infinity();
+    auto meeting = start == goal ? start : -1;
+    paths.set(start, 0, -1);
+    reverse.set(goal, 0, -1);
+    forward_open.push(start, potential(start));
+    backward_open.push(goal, -potential(goal));
+
+    const auto expand = [&](const G& graph, ShortestPaths& own, const ShortestPaths& other, IndexedHeap<float>& open, std::vector<bool>& settled, const float sign)
+    {
+        const auto vertex = open.pop();
+        const auto distance = own.get_distance(vertex);
+        settled[vertex] = true;
+        own.count_expansion();
+        graph.for_each_neighbor(vertex, [&](const int to, const float weight)
+        {
+            const auto computed_distance = distance + weight;
+            if (settled[to] || computed_distance >= own.get_distance(to))
+                return;
+            own.set(to, computed_distance, vertex);
+            open.push_or_decrease(to, computed_distance + sign * potential(to));
+            if (other.is_reached(to) && computed_distance + other.get_distance(to) < best)
+            {
+                best = computed_distance + other.get_distance(to);
+                meeting = to;
+            }
+        });
+    };
+
+    while (!forward_open.is_empty() && !backward_open.is_empty())
+    {
+        if (forward_open.top_key() + backward_open.top_key() >= best)
+            break;
+        if (forward_open.size() <= backward_open.size())
+            expand(forward, paths, reverse, forward_open, forward_settled, 1);
+        else
+            expand(backward, reverse, paths, backward_open, backward_settled, -1);
+    }
+
+    // The backward half of the path is hung onto the forward predecessors so extract_path sees one path
+    paths.count_expansion(reverse.get_expanded());
+    if (meeting == -1)
+    {
+        paths.set(goal, std::numeric_limits<float>::infinity(), -1);
+        return paths;
+    }
+    paths.set(meeting, best - reverse.get_distance(meeting), paths.get_predecessor(meeting));
+    for (auto vertex = meeting; vertex != goal;)
+    {
+        const auto next = reverse.get_predecessor(vertex);
+        paths.set(next, best - reverse.get_distance(next), vertex);
+        vertex = next;
+    }
+    return paths;
+}
+
+/**
+ * \brief Finds the shortest path between two vertexes with a Dijkstra search from each end.
+ * \tparam G The type of the graphs, it needs size() and for_each_neighbor(vertex, f).
+ * \param forward The graph to search from the start.
+ * \param backward The graph with every edge reversed, the same graph if every edge goes both ways.
+ * \param start The index of the starting vertex.
+ * \param goal The index of the goal vertex.
+ * \return The shortest path to the goal.
+ */
+template <class G>
+ShortestPaths bidirectional_dijkstra(const G& forward, const G& backward, const int start, const int goal)
+{
+    return bidirectional_search(forward, backward, start, goal, [](int) { return 0.0f; });
+}
+
+/**
+ * \brief Finds the shortest path between two vertexes with an A* search from each end.
+ * The two heuristics are averaged into one potential, (to_goal(v) - to_start(v)) / 2, that stays consistent for both
+ * searches, so the usual bidirectional stopping rule still gives the optimal path.
+ * \tparam G The type of the graphs, it needs size() and for_each_neighbor(vertex, f).
+ * \tparam ToGoal Callable that returns a consistent lower bound on the distance from a vertex to the goal.
+ * \tparam ToStart Callable that returns a consistent lower bound on the distance from the start to a vertex.
+ * \param forward The graph to search from the start.
+ * \param backward The graph with every edge reversed, the same graph if every edge goes both ways.
+ * \param start The index of the starting vertex.
+ * \param goal The index of the goal vertex.
+ * \param to_goal The heuristic of the forward search.
+ * \param to_start The heuristic of the backward search.
+ * \return The shortest path to the goal.
+ */
+template <class G, class ToGoal, class ToStart>
+ShortestPaths bidirectional_astar(const G& forward, const G& backward, const int start, const int goal, ToGoal to_goal, ToStart to_start)
+{
+    return bidirectional_search(forward, backward, start, goal, [&to_goal, &to_start](const int vertex)
+    {
+        return (to_goal(vertex) - to_start(vertex)) / 2;
+    });
+}
+
+inline ShortestPaths::ShortestPaths(int size)
+{
+    this->distances = std::vector<float>(size, std::numeric_limits<float>::infinity());
+    this->predecessors = std::vector<int>(size, -1);
+}
+
+inline void ShortestPaths::set(int vertex, float distance, int predecessor)
+{
+    this->distances[vertex] = distance;
+    this->predecessors[vertex] = predecessor;
+}
+
+inline float ShortestPaths::get_distance(int vertex) const
+{
+    return this->distances[vertex];
+}
+
+inline int ShortestPaths::get_predecessor(int vertex) const
+{
+    return this->predecessors[vertex];
+}
+
+inline bool ShortestPaths::is_reached(int vertex) const
+{
+    return this->distances[vertex] != std::numeric_limits<float>::infinity();
+}
+
+inline int ShortestPaths::path_length(int goal) const
+{
+    if (!this->is_reached(goal))
+        return 0;
+    auto length = 0;
+    for (auto vertex = goal; vertex != -1; vertex = this->predecessors[vertex])
+        length++;
+    return length;
+}
+
+inline std::span<int> ShortestPaths::extract_path(int goal, std::span<int> output) const
+{
+    const auto length = this->path_length(goal);
+    if (length > static_cast<int>(output.size()))
+        throw std::length_error("The output buffer is shorter than the path");
+    auto vertex = goal;
+    for (auto i = length - 1; i >= 0; i--)
+    {
+        output[i] = vertex;
+        vertex = this->predecessors[vertex];
+    }
+    return output.first(length);
+}
+
+inline void ShortestPaths::count_expansion(int count)
+{
+    this->expanded += count;
+}
+
+inline int ShortestPaths::get_expanded() const
+{
+    return this->expanded;
+}
+
+inline void ShortestPaths::count_reopening()
+{
+    this->reopened++;
+}
+
+inline int ShortestPaths::get_reopened() const
+{
+    return this->reopened;
+}
+
+inline int ShortestPaths::size() const
+{
+    return static_cast<int>(this->distances.size());
+}
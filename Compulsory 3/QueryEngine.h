@@ -0,0 +1,360 @@
+#pragma once
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <limits>
+#include <span>
+#include <stdexcept>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "IndexedHeap.h"
+#include "PathFinding.h"
+
+/**
+ * \brief A path request for QueryEngine.
+ */
+struct PathQuery
+{
+    /**
+     * \brief The index of the starting vertex.
+     */
+    int start;
+    /**
+     * \brief The index of the goal vertex.
+     */
+    int goal;
+};
+
+/**
+ * \brief The arrays of one A* search, reused for every query a thread runs.
+ * Every distance is stamped with the query that wrote it and entries with an older stamp count as unreached,
+ * so starting a new query is a counter increment instead of clearing arrays the size of the graph.
+ * Workspaces are aligned to cache lines so the counters of threads next to each other in a vector do not share one.
+ */
+class alignas(64) SearchWorkspace
+{
+    std::vector<float> distances;
+    std::vector<int> predecessors;
+    std::vector<uint32_t> stamps;
+    uint32_t epoch = 0;
+    IndexedHeap<AStarKey> open;
+    int expanded = 0;
+
+    void next_epoch();
+    void set(int vertex, float distance, int predecessor);
+public:
+    /**
+     * \brief Creates a workspace for graphs of the given size.
+     * \param size The amount of vertexes in the graph.
+     */
+    explicit SearchWorkspace(int size = 0);
+
+    /**
+     * \brief Finds the shortest path between two vertexes with A*, replacing the result of the previous search.
+     * \tparam G The type of the graph, it needs size() and for_each_neighbor(vertex, f).
+     * \tparam Heuristic Callable that returns a consistent lower bound on the distance from a vertex to the goal.
+     * \param graph The graph to search, it is only read.
+     * \param start The index of the starting vertex.
+     * \param goal The index of the goal vertex.
+     * \param heuristic The lower bound to guide the search with.
+     * \return The length of the shortest path, infinity if the goal can not be reached.
+     */
+    template <class G, class Heuristic>
+    float search(const G& graph, int start, int goal, Heuristic heuristic);
+
+    /**
+     * \brief Gets the length of the shortest known path to a vertex in the last search.
+     * \param vertex The index of the vertex.
+     * \return The length of the path, infinity if the vertex was not reached.
+     */
+    [[nodiscard]] float get_distance(int vertex) const;
+
+    /**
+     * \brief Gets the amount of vertexes on the path to a vertex in the last search, both ends included.
+     * \param goal The index of the last vertex on the path.
+     * \return The amount of vertexes on the path, 0 if the goal was not reached.
+     */
+    [[nodiscard]] int path_length(int goal) const;
+
+    /**
+     * \brief Writes the path from the start of the last search to a vertex into a buffer.
+     * \param goal The index of the last vertex on the path.
+     * \param output The buffer to write the path to, it has to fit path_length(goal) vertexes.
+     * \return The part of the buffer that holds the path, empty if the goal was not reached.
+     */
+    std::span<int> extract_path(int goal, std::span<int> output) const;
+
+    /**
+     * \brief Gets the amount of vertexes the last search expanded.
+     * \return The amount of expansions.
+     */
+    [[nodiscard]] int get_expanded() const;
+};
+
+/**
+ * \brief The distances and paths of a batch of queries, with every path in one shared array.
+ */
+class BatchResult
+{
+    std::vector<float> distances;
+    std::vector<int> offsets;
+    std::vector<int> vertexes;
+public:
+    /**
+     * \brief Creates a result from already packed arrays.
+     * \param distances The length of the path of every query.
+     * \param offsets The first vertex of the path of every query, followed by the total amount of vertexes.
+     * \param vertexes The paths of all queries after each other.
+     */
+    BatchResult(std::vector<float> distances, std::vector<int> offsets, std::vector<int> vertexes);
+
+    /**
+     * \brief Gets the length of the shortest path of a query.
+     * \param query The index of the query in the batch.
+     * \return The length of the path, infinity if the goal can not be reached.
+     */
+    [[nodiscard]] float get_distance(int query) const;
+
+    /**
+     * \brief Gets the shortest path of a query.
+     * \param query The index of the query in the batch.
+     * \return The vertexes from the start to the goal, empty if the goal can not be reached.
+     */
+    [[nodiscard]] std::span<const int> get_path(int query) const;
+
+    /**
+     * \brief Gets the amount of queries in the batch.
+     * \return The amount of queries.
+     */
+    [[nodiscard]] int size() const;
+};
+
+/**
+ * \brief Answers batches of path queries on a graph that does not change, spread over several threads.
+ * Every thread has its own SearchWorkspace and takes queries in small chunks from a shared counter, so a thread that
+ * gets short queries keeps working while another one finishes a long one.
+ * \tparam G The type of the graph, it needs size() and for_each_neighbor(vertex, f) that are safe to call from several threads.
+ */
+template <class G>
+class QueryEngine
+{
+    const G* graph;
+    std::vector<SearchWorkspace> workspaces;
+
+    static constexpr int chunk_size = 16;
+public:
+    /**
+     * \brief Creates the engine and a workspace for every thread.
+     * \param graph The graph to search, it has to outlive the engine and must not change while a batch runs.
+     * \param thread_count The amount of threads to use, 0 for one per hardware thread.
+     */
+    explicit QueryEngine(const G& graph, int thread_count = 0);
+
+    /**
+     * \brief Answers a batch of queries with Dijkstra's algorithm.
+     * \param queries The start and goal of every query.
+     * \return The distance and path of every query, in the same order as the queries.
+     */
+    BatchResult run(std::span<const PathQuery> queries);
+
+    /**
+     * \brief Answers a batch of queries with A*.
+     * \tparam MakeHeuristic Callable that takes a goal and returns the heuristic for it.
+     * \param queries The start and goal of every query.
+     * \param make_heuristic Creates the heuristic for each query, it is called from several threads.
+     * \return The distance and path of every query, in the same order as the queries.
+     */
+    template <class MakeHeuristic>
+    BatchResult run(std::span<const PathQuery> queries, MakeHeuristic make_heuristic);
+
+    /**
+     * \brief Gets the amount of threads a batch is spread over.
+     * \return The amount of threads.
+     */
+    [[nodiscard]] int get_thread_count() const;
+};
+
+inline SearchWorkspace::SearchWorkspace(int size)
+    : open(size)
+{
+    this->distances = std::vector<float>(size);
+    this->predecessors = std::vector<int>(size);
+    this->stamps = std::vector<uint32_t>(size, 0);
+}
+
+inline void SearchWorkspace::next_epoch()
+{
+    // Stamps are only cleared when the counter wraps around, once every four billion searches
+    if (++this->epoch == 0)
+    {
+        std::ranges::fill(this->stamps, 0u);
+        this->epoch = 1;
+    }
+}
+
+inline void SearchWorkspace::set(int vertex, float distance, int predecessor)
+{
+    this->distances[vertex] = distance;
+    this->predecessors[vertex] = predecessor;
+    this->stamps[vertex] = this->epoch;
+}
+
+template <class G, class Heuristic>
+float SearchWorkspace::search(const G& graph, int start, int goal, Heuristic heuristic)
+{
+    this->next_epoch();
+    this->open.clear();
+    this->expanded = 0;
+    this->set(start, 0, -1);
+    this->open.push(start, { heuristic(start), 0 });
+    while (!this->open.is_empty())
+    {
+        const auto vertex = this->open.pop();
+        this->expanded++;
+        if (vertex == goal)
+            return this->distances[goal];
+        const auto distance = this->distances[vertex];
+        graph.for_each_neighbor(vertex, [&](const int to, const float weight)
+        {
+            const auto computed_distance = distance + weight;
+            if (computed_distance >= this->get_distance(to))
+                return;
+            const auto estimate = heuristic(to);
+            if (estimate == std::numeric_limits<float>::infinity())
+                return;
+            this->set(to, computed_distance, vertex);
+            this->open.push_or_decrease(to, { computed_distance + estimate, computed_distance });
+        });
+    }
+    return std::numeric_limits<float>::infinity();
+}
+
+inline float SearchWorkspace::get_distance(int vertex) const
+{
+    return this->stamps[vertex] == this->epoch ? this->distances[vertex] : std::numeric_limits<float>::infinity();
+}
+
+inline int SearchWorkspace::path_length(int goal) const
+{
+    if (this->stamps[goal] != this->epoch)
+        return 0;
+    auto length = 0;
+    for (auto vertex = goal; vertex != -1; vertex = this->predecessors[vertex])
+        length++;
+    return length;
+}
+
+inline std::span<int> SearchWorkspace::extract_path(int goal, std::span<int> output) const
+{
+    const auto length = this->path_length(goal);
+    if (static_cast<int>(output.size()) < length)
+        throw std::length_error("The output buffer is shorter than the path");
+    auto slot = length;
+    for (auto vertex = goal; slot > 0; vertex = this->predecessors[vertex])
+        output[--slot] = vertex;
+    return output.first(length);
+}
+
+inline int SearchWorkspace::get_expanded() const
+{
+    return this->expanded;
+}
+
+inline BatchResult::BatchResult(std::vector<float> distances, std::vector<int> offsets, std::vector<int> vertexes)
+{
+    this->distances = std::move(distances);
+    this->offsets = std::move(offsets);
+    this->vertexes = std::move(vertexes);
+}
+
+inline float BatchResult::get_distance(int query) const
+{
+    return this->distances[query];
+}
+
+inline std::span<const int> BatchResult::get_path(int query) const
+{
+    return std::span<const int>(this->vertexes).subspan(this->offsets[query], this->offsets[query + 1] - this->offsets[query]);
+}
+
+inline int BatchResult::size() const
+{
+    return static_cast<int>(this->distances.size());
+}
+
+template <class G>
+QueryEngine<G>::QueryEngine(const G& graph, int thread_count)
+{
+    if (thread_count <= 0)
+        thread_count = std::max(1, static_cast<int>(std::thread::hardware_concurrency()));
+    this->graph = &graph;
+    for (auto i = 0; i < thread_count; i++)
+        this->workspaces.emplace_back(graph.size());
+}
+
+template <class G>
+BatchResult QueryEngine<G>::run(std::span<const PathQuery> queries)
+{
+    return this->run(queries, [](int)
+    {
+        return [](int) { return 0.0f; };
+    });
+}
+
+template <class G>
+template <class MakeHeuristic>
+BatchResult QueryEngine<G>::run(std::span<const PathQuery> queries, MakeHeuristic make_heuristic)
+{
+    const auto count = static_cast<int>(queries.size());
+    const auto thread_count = std::min(this->get_thread_count(), (count + chunk_size - 1) / chunk_size);
+    auto distances = std::vector<float>(count);
+    // Each thread appends its paths to its own buffer, and they are packed in query order at the end
+    auto buffers = std::vector<std::vector<int>>(thread_count);
+    auto owners = std::vector<int>(count);
+    auto starts = std::vector<int>(count);
+    auto lengths = std::vector<int>(count);
+    auto next = std::atomic<int>(0);
+
+    const auto work = [&](const int thread)
+    {
+        auto& workspace = this->workspaces[thread];
+        auto& buffer = buffers[thread];
+        for (auto first = next.fetch_add(chunk_size); first < count; first = next.fetch_add(chunk_size))
+        {
+            for (auto i = first; i < std::min(first + chunk_size, count); i++)
+            {
+                const auto [start, goal] = queries[i];
+                distances[i] = workspace.search(*this->graph, start, goal, make_heuristic(goal));
+                owners[i] = thread;
+                starts[i] = static_cast<int>(buffer.size());
+                lengths[i] = workspace.path_length(goal);
+                buffer.resize(buffer.size() + lengths[i]);
+                workspace.extract_path(goal, std::span<int>(buffer).subspan(starts[i]));
+            }
+        }
+    };
+
+    {
+        auto threads = std::vector<std::jthread>();
+        for (auto thread = 1; thread < thread_count; thread++)
+            threads.emplace_back(work, thread);
+        if (thread_count > 0)
+            work(0);
+    }
+
+    auto offsets = std::vector<int>(count + 1, 0);
+    for (auto i = 0; i < count; i++)
+        offsets[i + 1] = offsets[i] + lengths[i];
+    auto vertexes = std::vector<int>(offsets[count]);
+    for (auto i = 0; i < count; i++)
+        std::copy_n(buffers[owners[i]].begin() + starts[i], lengths[i], vertexes.begin() + offsets[i]);
+    return BatchResult(std::move(distances), std::move(offsets), std::move(vertexes));
+}
+
+template <class G>
+int QueryEngine<G>::get_thread_count() const
+{
+    return static_cast<int>(this->workspaces.size());
+}
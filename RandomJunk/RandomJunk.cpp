@@ -1,21 +1,105 @@
 ﻿ #include <algorithm>
  #include <array>
+ #include <atomic>
  #include <chrono>
+ #include <cstdlib>
  #include <iostream>
+ #include <memory>
+ #include <new>
  #include <ostream>
  #include <random>
  #include <vector>
  #include <Windows.h>
+ #include <Psapi.h>
+ #include <powerbase.h>
  #include <cstdio>
  #include <iomanip>
+ #include <numeric>
+ #include <span>
+ #include <sstream>
  #include <string>
+ #include <thread>
+
+ #pragma comment(lib, "PowrProf.lib")
 
  using namespace std;
  using namespace std::chrono;
 
- bool debug = false;
+ // Compile time switch, true makes the timed runs use LoggingTrace and print the sorted array
+ constexpr bool debug = false;
  char separator = ' ';
 
+ namespace memory {
+     /**
+      * @brief Heap usage counted by the global operator new and delete below
+      */
+     struct AllocationStats
+     {
+         long long allocations = 0;
+         long long bytes = 0;
+         long long live = 0;
+         long long peak = 0;
+     };
+
+     // Per thread so concurrent measurements do not see each other's allocations
+     thread_local AllocationStats stats;
+
+     // Every block carries its size in front of it so delete knows how much is released
+     constexpr size_t header_size = alignof(max_align_t);
+
+     /**
+      * @brief Resets the counters of the calling thread and moves the peak down to what is live now
+      */
+     void begin_measure()
+     {
+         stats.allocations = 0;
+         stats.bytes = 0;
+         stats.peak = stats.live;
+     }
+
+     /**
+      * @brief Gets the current working set (RSS) of the whole process in bytes
+      *
+      * The peak working set never goes down once one large case has run, so a run is measured as
+      * the growth of this value from before the run to the end of it instead.
+      */
+     size_t resident_bytes()
+     {
+         PROCESS_MEMORY_COUNTERS counters;
+         if (!GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters)))
+             return 0;
+         return counters.WorkingSetSize;
+     }
+ }
+
+ void* operator new(const size_t size)
+ {
+     auto* block = static_cast<unsigned char*>(malloc(size + memory::header_size));
+     if (block == nullptr)
+         throw bad_alloc();
+     *reinterpret_cast<size_t*>(block) = size;
+     memory::stats.allocations++;
+     memory::stats.bytes += static_cast<long long>(size);
+     memory::stats.live += static_cast<long long>(size);
+     if (memory::stats.live > memory::stats.peak)
+         memory::stats.peak = memory::stats.live;
+     return block + memory::header_size;
+ }
+
+ void operator delete(void* pointer) noexcept
+ {
+     if (pointer == nullptr)
+         return;
+     auto* block = static_cast<unsigned char*>(pointer) - memory::header_size;
+     memory::stats.live -= static_cast<long long>(*reinterpret_cast<size_t*>(block));
+     free(block);
+ }
+
+ void operator delete(void* pointer, size_t) noexcept
+ {
+     operator delete(pointer);
+ }
+
  namespace console {
      class ModifierException final : public std::exception
      {
@@ -146,17 +230,7 @@
      }();
  }
 
- vector<int> merge(vector<int> a, vector<int> b)
- {
-     vector<int> ret = vector<int>();
-     for (auto i : a)
-         ret.push_back(i);
-     for (auto i : b)
-         ret.push_back(i);
-     return ret;
- }
-
- void print(const vector<int> arr, const int altColLen = -1, int start = 0, int len = -1)
+ void print(span<const int> arr, const int altColLen = -1, int start = 0, int len = -1)
  {
      if (start < 0)
      {
@@ -186,209 +260,227 @@
      cout << endl;
  }
 
- void swap(vector<int>& arr, int i, int j)
+ // Tracing policies for the sorting algorithms. Every algorithm takes its policy as a template
+ // parameter and routes its comparisons and swaps through it, so the choice is made at compile
+ // time and NoTrace leaves nothing behind in the inner loops.
+
+ /**
+  * @brief Tracing policy that does nothing
+  */
+ struct NoTrace
+ {
+     static bool less(const int a, const int b) { return a < b; }
+     static void swap(int, int) {}
+     template <typename F> static void log(F&&) {}
+ };
+
+ /**
+  * @brief Tracing policy that counts the comparisons and swaps an algorithm does
+  */
+ struct CountingTrace
+ {
+     long long compares = 0;
+     long long swaps = 0;
+
+     bool less(const int a, const int b)
+     {
+         compares++;
+         return a < b;
+     }
+     void swap(int, int) { swaps++; }
+     template <typename F> static void log(F&&) {}
+ };
+
+ /**
+  * @brief Tracing policy that prints every swap and the algorithm specific messages
+  */
+ struct LoggingTrace
+ {
+     static bool less(const int a, const int b) { return a < b; }
+     static void swap(const int a, const int b)
+     {
+         cout << "Swap: " << a << " <-> " << b << endl;
+     }
+     template <typename F> static void log(F&& f) { f(cout); }
+ };
+
+ template <class Trace> void swap(span<int> arr, int i, int j, Trace& trace)
  {
-     if (debug)
-         cout << "Swap: " << arr[i] << " <-> " << arr[j] << endl;
+     trace.swap(arr[i], arr[j]);
      const int temp = arr[i];
      arr[i] = arr[j];
      arr[j] = temp;
  }
 
- void swap(int& i, int& j)
+ template <class Trace> void swap(int& i, int& j, Trace& trace)
  {
-     if (debug)
-         cout << "Swap: " << i << " <-> " << j << endl;
+     trace.swap(i, j);
      const int temp = i;
      i = j;
      j = temp;
  }
 
- vector<int> bubble_sort(vector<int> arr)
+ // All sorts work in place on the span they are given. Merge and radix sort
+ // need an auxiliary buffer of the same size, which the caller owns so that
+ // allocating it never ends up inside a timed region.
+
+ template <class Trace> void bubble_sort(span<int> arr, Trace& trace)
  {
+     const int size = static_cast<int>(arr.size());
      bool swapped = true;
      while (swapped)
      {
          swapped = false;
-         for (int i = 0; i < arr.size() - 1; i++)
+         for (int i = 0; i < size - 1; i++)
          {
-             if (arr[i] > arr[i + 1])
+             if (trace.less(arr[i + 1], arr[i]))
              {
-                 swap(arr, i, i + 1);
+                 swap(arr, i, i + 1, trace);
                  swapped = true;
              }
          }
      }
-     return arr;
  }
 
- vector<int> insertion_sort(vector<int> arr)
+ template <class Trace> void insertion_sort(span<int> arr, Trace& trace)
  {
+     const int size = static_cast<int>(arr.size());
      int i = 1;
-     while (i < arr.size())
+     while (i < size)
      {
          int j = i;
-         while (j > 0 && arr[j - 1] > arr[j])
+         while (j > 0 && trace.less(arr[j], arr[j - 1]))
          {
-             swap(arr, j, j - 1);
+             swap(arr, j, j - 1, trace);
              j--;
          }
          i++;
      }
-     return arr;
  }
 
- vector<int> selection_sort(vector<int> arr)
+ template <class Trace> void selection_sort(span<int> arr, Trace& trace)
  {
-     for (int i = 0; i < arr.size() - 1; i++)
+     const int size = static_cast<int>(arr.size());
+     for (int i = 0; i < size - 1; i++)
      {
          int min = i;
-         for (int j = i + 1; j < arr.size(); j++)
+         for (int j = i + 1; j < size; j++)
          {
-             if (arr[j] < arr[min])
+             if (trace.less(arr[j], arr[min]))
                  min = j;
          }
-         if (debug)
-             cout << "Min: " << min << " , arr: " << arr[min] << endl;
+         trace.log([&](ostream& out) { out << "Min: " << min << " , arr: " << arr[min] << endl; });
          if (min != i)
          {
-             swap(arr, i, min);
+             swap(arr, i, min, trace);
          }
      }
-     return arr;
  }
 
- vector<vector<int>> merge_divide(vector<int> arr)
+ /**
+  * @brief Merges the two sorted halves of arr back into arr
+  *
+  * Only the lower half is copied out. The merge writes arr from the front, which never overtakes the unread part of
+  * the upper half because k = i + (j - half) <= j.
+  *
+  * @param arr The array where [0, half) and [half, size) are sorted
+  * @param scratch Buffer with room for at least half elements
+  * @param half The index the upper half starts at
+  * @param trace The tracing policy
+  */
+ template <class Trace> void merge_combine(span<int> arr, span<int> scratch, const size_t half, Trace& trace)
  {
-     vector<vector<int>> result = vector<vector<int>>(2);
-     result[0] = vector<int>();
-     result[1] = vector<int>();
-     const int half = arr.size() / 2;
-     for (int i = 0; i < arr.size(); ++i)
+     copy(arr.begin(), arr.begin() + half, scratch.begin());
+     size_t i = 0, j = half, k = 0;
+     while (i < half && j < arr.size())
      {
-         if (i < half)
-             result[0].push_back(arr[i]);
+         if (!trace.less(arr[j], scratch[i]))
+             arr[k++] = scratch[i++];
          else
-             result[1].push_back(arr[i]);
+             arr[k++] = arr[j++];
      }
-     return result;
+     while (i < half)
+         arr[k++] = scratch[i++];
  }
 
- vector<int> merge_combine(vector<vector<int>> arrs)
+ template <class Trace> void merge_sort(span<int> arr, span<int> scratch, Trace& trace)
  {
-     vector<int> result;
-     int i = 0, j = 0;
-     const vector<int> arr1 = arrs[0];
-     const vector<int> arr2 = arrs[1];
-     while (i < arr1.size() && j < arr2.size())
-     {
-         if (arr1[i] < arr2[j])
-             result.push_back(arr1[i++]);
-         else
-             result.push_back(arr2[j++]);
-     }
-     while (i < arr1.size())
-         result.push_back(arr1[i++]);
-     while (j < arr2.size())
-         result.push_back(arr2[j++]);
-     return result;
- }
-
- vector<int> merge_divide_combine(vector<vector<int>> arrs)
- {
-     const vector<int> arr1 = arrs[0];
-     const vector<int> arr2 = arrs[1];
-     if (debug)
-     {
-         cout << "new merge: " << endl;
-         cout << "arr1: ";
-         print(arr1);
-         cout << "arr2: ";
-         print(arr2);
-     }
-     if (arr1.size() > 1)
-         arrs[0] = merge_divide_combine(merge_divide(arr1));
-     if (arr2.size() > 1)
-         arrs[1] = merge_divide_combine(merge_divide(arr2));
-     if (debug)
+     if (arr.size() <= 1)
+         return;
+     const size_t half = arr.size() / 2;
+     // Both halves are done before the merge so they can share the front of the buffer
+     merge_sort(arr.first(half), scratch, trace);
+     merge_sort(arr.subspan(half), scratch, trace);
+     trace.log([&](ostream& out)
      {
-         cout << "after merge: " << endl;
-         cout << "arr1: ";
-         print(arr1);
-         cout << "arr2: ";
-         print(arr2);
-     }
-
-     return merge_combine(arrs);
+         out << "new merge: " << endl;
+         out << "arr1: ";
+         print(arr.first(half));
+         out << "arr2: ";
+         print(arr.subspan(half));
+     });
+     merge_combine(arr, scratch, half, trace);
  }
 
- vector<int> merge_sort(vector<int> arr)
- {
-     return merge_divide_combine(merge_divide(arr));
- }
-
- int partition(vector<int>& arr, int lo, int hi)
+ template <class Trace> int partition(span<int> arr, int lo, int hi, Trace& trace)
  {
      const int pivot = arr[(hi - lo) / 2 + lo];
      int i = lo - 1, j = hi + 1;
      while (true)
      {
-         do i++;	while (arr[i] < pivot);
-         do j--;	while (arr[j] > pivot);
+         do i++;	while (trace.less(arr[i], pivot));
+         do j--;	while (trace.less(pivot, arr[j]));
          if (i >= j) return j;
-         swap(arr, i, j);
+         swap(arr, i, j, trace);
      }
  }
 
- vector<int> quick_sort(vector<int> arr, int lo, int hi)
+ template <class Trace> void quick_sort(span<int> arr, int lo, int hi, Trace& trace)
  {
-     if (arr.size() <= 1)
-         return arr;
-     if (debug)
+     trace.log([&](ostream& out)
      {
-         cout << "lo: " << lo << endl;
-         cout << "hi: " << hi << endl;
-     }
+         out << "lo: " << lo << endl;
+         out << "hi: " << hi << endl;
+     });
      if (lo >= 0 && hi >= 0 && lo < hi)
      {
-         int p = partition(arr, lo, hi);
-         arr = quick_sort(arr, lo, p);
-         arr = quick_sort(arr, p + 1, hi);
+         const int p = partition(arr, lo, hi, trace);
+         quick_sort(arr, lo, p, trace);
+         quick_sort(arr, p + 1, hi, trace);
      }
-     return arr;
  }
 
- vector<int> cocktail_sort(vector<int> arr)
+ template <class Trace> void cocktail_sort(span<int> arr, Trace& trace)
  {
-     int lower = 0, upper = arr.size() - 1;
+     const int size = static_cast<int>(arr.size());
+     int lower = 0, upper = size - 1;
      while (lower <= upper)
      {
-         for (int i = lower; i < arr.size() - 1; ++i)
+         for (int i = lower; i < size - 1; ++i)
          {
-             if (arr[i] > arr[i + 1])
+             if (trace.less(arr[i + 1], arr[i]))
              {
-                 swap(arr, i, i + 1);
+                 swap(arr, i, i + 1, trace);
              }
          }
          for (int i = upper; i > lower; --i)
          {
-             if (arr[i - 1] > arr[i])
+             if (trace.less(arr[i], arr[i - 1]))
              {
-                 swap(arr, i - 1, i);
+                 swap(arr, i - 1, i, trace);
              }
          }
          lower++;
          upper--;
      }
-     return arr;
  }
 
- int leaf_search(vector<int> arr, int i, int rightIndex)
+ template <class Trace> int leaf_search(span<const int> arr, int i, int rightIndex, Trace& trace)
  {
      int j = i;
      while (2 * j + 2 <= rightIndex)
      {
-         if (arr[2 * j + 2] > arr[2 * j + 1])
+         if (trace.less(arr[2 * j + 1], arr[2 * j + 2]))
              j = 2 * j + 2;
          else
              j = 2 * j + 1;
@@ -398,140 +490,370 @@
      return j;
  }
 
- void shift_down(vector<int>& arr, int i, int rightIndex)
+ template <class Trace> void shift_down(span<int> arr, int i, int rightIndex, Trace& trace)
  {
-     int j = leaf_search(arr, i, rightIndex);
-     while (arr[i] > arr[j])
+     int j = leaf_search(arr, i, rightIndex, trace);
+     while (trace.less(arr[j], arr[i]))
          j = (j - 1) / 2;
      int temp = arr[j];
      arr[j] = arr[i];
      while (j > i)
      {
          int p = (j - 1) / 2;
-         swap(temp, arr[p]);
+         swap(temp, arr[p], trace);
          j = p;
      }
  }
 
- void heapify(vector<int>& arr, int rightIndex)
+ template <class Trace> void heapify(span<int> arr, int rightIndex, Trace& trace)
  {
      int start = (rightIndex - 2) / 2;
      while (start >= 0)
      {
-         shift_down(arr, start, rightIndex - 1);
+         shift_down(arr, start, rightIndex - 1, trace);
          start--;
      }
  }
 
- vector<int> heap_sort(vector<int> arr)
+ template <class Trace> void heap_sort(span<int> arr, Trace& trace)
  {
-     int count = arr.size();
-     heapify(arr, count--);
+     int count = static_cast<int>(arr.size());
+     heapify(arr, count--, trace);
      while (count > 0)
      {
-         swap(arr, 0, count--);
-         shift_down(arr, 0, count);
+         swap(arr, 0, count--, trace);
+         shift_down(arr, 0, count, trace);
      }
-     return arr;
  }
 
- vector<int> intro_sort(vector<int> arr, int depth)
+ template <class Trace> void intro_sort(span<int> arr, int depth, Trace& trace)
  {
      if (arr.size() < 16)
      {
-         return insertion_sort(arr);
+         return insertion_sort(arr, trace);
      }
      if (depth == 0)
      {
-         return heap_sort(arr);
+         return heap_sort(arr, trace);
      }
-     const int p = partition(arr, 0, arr.size() - 1);
-     auto lower = intro_sort(vector<int>(arr.begin(), arr.begin() + p), depth--);
-     auto upper = intro_sort(vector<int>(arr.begin() + p, arr.end()), depth);
-     return merge(lower, upper);
+     const int p = partition(arr, 0, static_cast<int>(arr.size()) - 1, trace);
+     intro_sort(arr.first(p + 1), depth - 1, trace);
+     intro_sort(arr.subspan(p + 1), depth - 1, trace);
  }
 
- vector<int> radix_sort(vector<int> arr)
+ /**
+  * @brief LSD radix sort in base 10, it never compares elements so the policy only sees the moves it logs
+  */
+ template <class Trace> void radix_sort(span<int> arr, span<int> scratch, Trace& trace)
  {
-     int max = *max_element(arr.begin(), arr.end());
-     int exp = 1;
-     vector<int> output(arr.size());
-     while (max / exp > 0)
+     if (arr.empty())
+         return;
+     const int max = *max_element(arr.begin(), arr.end());
+     span<int> from = arr;
+     span<int> to = scratch.first(arr.size());
+     array<int, 10> count{};
+     for (long long exp = 1; max / exp > 0; exp *= 10)
      {
-         vector<int> count(10);
-         for (int i : arr)
+         trace.log([&](ostream& out) { out << "exp: " << exp << endl; });
+         count.fill(0);
+         for (int i : from)
              count[(i / exp) % 10]++;
          for (int i = 1; i < 10; ++i)
              count[i] += count[i - 1];
-         for (int i = arr.size() - 1; i >= 0; --i)
-         {
-             output[count[(arr[i] / exp) % 10] - 1] = arr[i];
-             count[(arr[i] / exp) % 10]--;
-         }
-         for (int i = 0; i < arr.size(); ++i)
-             arr[i] = output[i];
-         exp *= 10;
+         for (int i = static_cast<int>(from.size()) - 1; i >= 0; --i)
+             to[--count[(from[i] / exp) % 10]] = from[i];
+         std::swap(from, to);
      }
-     return output;
+     if (from.data() != arr.data())
+         copy(from.begin(), from.end(), arr.begin());
  }
 
- vector<int> sort(const SortType type, vector<int> arr)
+ /**
+  * @brief Gets how big a scratch buffer an algorithm needs
+  *
+  * @param type The algorithm
+  * @param size The array size
+  * @return The scratch buffer size in elements
+  */
+ size_t scratch_size(const SortType type, const size_t size)
+ {
+     switch (type)
+     {
+     case MergeSort:
+         return size / 2;
+     case RadixSort:
+         return size;
+     default:
+         return 0;
+     }
+ }
+
+ /**
+  * @brief Sorts arr in place with the given algorithm
+  *
+  * @param type The algorithm to use
+  * @param arr The array to sort
+  * @param scratch Buffer of at least scratch_size(type, arr.size()) elements
+  * @param trace The tracing policy that sees every comparison and swap
+  */
+ template <class Trace> void sort(const SortType type, span<int> arr, span<int> scratch, Trace& trace)
  {
      switch (type)
      {
      case BubbleSort:
-         return bubble_sort(arr);
+         return bubble_sort(arr, trace);
      case InsertionSort:
-         return insertion_sort(arr);
+         return insertion_sort(arr, trace);
      case SelectionSort:
-         return selection_sort(arr);
+         return selection_sort(arr, trace);
      case MergeSort:
-         return merge_sort(arr);
+         return merge_sort(arr, scratch, trace);
      case QuickSort:
-         return quick_sort(arr, 0, arr.size() - 1);
+         return quick_sort(arr, 0, static_cast<int>(arr.size()) - 1, trace);
      case CocktailSort:
-         return cocktail_sort(arr);
+         return cocktail_sort(arr, trace);
      case HeapSort:
-         return heap_sort(arr);
+         return heap_sort(arr, trace);
      case IntroSort:
-         return intro_sort(arr, 2 * static_cast<int>(log(arr.size())));
+         return intro_sort(arr, 2 * static_cast<int>(log(arr.size())), trace);
      case RadixSort:
-         return radix_sort(arr);
+         return radix_sort(arr, scratch, trace);
      default:
          break;
      }
  }
 
- auto rnd = default_random_engine{ random_device{}() };
-
- vector<double> time(const SortType type, int size, int times = 10)
+ /**
+  * @brief Sorts arr in place with the given algorithm without any tracing
+  */
+ void sort(const SortType type, span<int> arr, span<int> scratch)
  {
-     vector<double> result = vector<double>(3);
-     result[0] = -1;
-     vector<int> arr = vector<int>();
-     vector<int> sorted;
-     for (int i = 0; i < size; ++i)
+     NoTrace trace;
+     sort(type, arr, scratch, trace);
+ }
+
+ // The tracing policy of the timed runs
+ using Trace = conditional_t<debug, LoggingTrace, NoTrace>;
+
+ // One engine per thread, the benchmark cases can run in parallel
+ thread_local auto rnd = default_random_engine{ random_device{}() };
+
+ namespace progress {
+     /**
+      * @brief A progress message, fixed size so the benchmark thread only copies a few integers
+      */
+     struct Record
      {
-         arr.push_back(i + 1);
-     }
+         SortType type;
+         int size;
+         int iteration;
+         int times;
+     };
+
+     /**
+      * @brief Lock-free single producer, single consumer ring buffer of records
+      *
+      * The producer never waits, when the consumer falls behind and the buffer is full the record
+      * is dropped and counted instead.
+      */
+     class Queue
+     {
+         static constexpr size_t capacity = 1024;
+         array<Record, capacity> records{};
+         alignas(64) atomic<size_t> head = 0;
+         alignas(64) atomic<size_t> tail = 0;
+         atomic<long long> dropped = 0;
+
+     public:
+         void push(const Record& record)
+         {
+             const size_t t = tail.load(memory_order_relaxed);
+             if (t - head.load(memory_order_acquire) == capacity)
+             {
+                 dropped.fetch_add(1, memory_order_relaxed);
+                 return;
+             }
+             records[t % capacity] = record;
+             tail.store(t + 1, memory_order_release);
+         }
+
+         bool pop(Record& record)
+         {
+             const size_t h = head.load(memory_order_relaxed);
+             if (h == tail.load(memory_order_acquire))
+                 return false;
+             record = records[h % capacity];
+             head.store(h + 1, memory_order_release);
+             return true;
+         }
+
+         [[nodiscard]] long long get_dropped() const
+         {
+             return dropped.load(memory_order_relaxed);
+         }
+     };
+
+     /**
+      * @brief Prints the records of any number of queues from a background thread
+      *
+      * Each producer thread gets its own queue. The logger thread formats the records, writes them
+      * without flushing and only flushes when every queue is empty, so the benchmark threads never
+      * touch the console themselves.
+      */
+     class Logger
+     {
+         vector<unique_ptr<Queue>> queues;
+         atomic<bool> running = true;
+         thread worker;
+
+         static void print(const Record& record)
+         {
+             cout << "Running " << record.type << " of size " << console::Modifier(console::FG_GREEN) << record.size << console::Modifier(console::FG_DEFAULT) << " , " << console::Modifier(console::FG_GREEN) << record.iteration + 1 << console::Modifier(console::FG_DEFAULT) << " out of " << console::Modifier(console::FG_BRIGHT_BLUE) << record.times << console::Modifier(console::FG_DEFAULT) << " times" << '\n';
+         }
+
+         void run()
+         {
+             Record record{};
+             while (true)
+             {
+                 const bool stopping = !running.load(memory_order_acquire);
+                 bool printed = false;
+                 for (const auto& queue : queues)
+                 {
+                     while (queue->pop(record))
+                     {
+                         print(record);
+                         printed = true;
+                     }
+                 }
+                 if (printed)
+                     continue;
+                 cout.flush();
+                 if (stopping)
+                     break;
+                 this_thread::sleep_for(milliseconds(1));
+             }
+         }
+
+     public:
+         /**
+          * @brief Starts the logger thread
+          *
+          * @param producers How many producer threads there are, each gets a queue
+          */
+         explicit Logger(const size_t producers)
+         {
+             for (size_t i = 0; i < producers; ++i)
+                 queues.push_back(make_unique<Queue>());
+             worker = thread(&Logger::run, this);
+         }
+
+         /**
+          * @brief Prints whatever is left in the queues and stops the logger thread
+          */
+         ~Logger()
+         {
+             running.store(false, memory_order_release);
+             worker.join();
+             long long dropped = 0;
+             for (const auto& queue : queues)
+                 dropped += queue->get_dropped();
+             if (dropped > 0)
+                 cout << dropped << " progress messages were dropped" << endl;
+         }
+
+         Logger(const Logger&) = delete;
+         Logger& operator=(const Logger&) = delete;
+
+         Queue& queue(const size_t producer)
+         {
+             return *queues[producer];
+         }
+     };
+ }
+
+ /**
+  * @brief Timing, operation counts and memory use for one algorithm and array size
+  */
+ struct TimeResult
+ {
+     double min = -1;
+     double avg = 0;
+     double max = 0;
+     long long compares = 0;
+     long long swaps = 0;
+     long long allocations = 0;
+     long long bytes = 0;
+     long long peakHeap = 0;
+     size_t rssGrowth = 0;
+     // How many of the runs left the array unsorted
+     int unsorted = 0;
+ };
+
+ /**
+  * @brief Times a sorting algorithm on shuffled arrays
+  *
+  * The input is generated and the work buffer is allocated before the first run. Each run only
+  * copies the shuffled input into the work buffer outside of the clock, so the measured time
+  * is the sort itself. The timed runs use the Trace policy (NoTrace unless debugging), one extra
+  * untimed run with CountingTrace on the last input gives the comparison and swap counts.
+  *
+  * Heap use is measured per run from just before the scratch buffer is allocated until the sort
+  * is done, so the memory columns include the scratch the algorithm needs but not the input.
+  * The working set growth is process wide, with --jobs above 1 it also counts the pages the other
+  * running cases touched in the meantime.
+  *
+  * @param type The algorithm to time
+  * @param size The array size
+  * @param times How many runs to do
+  * @param log The queue to report progress to, nullptr to run quietly
+  * @return The times in µs, the operation counts, the largest memory use of the runs and how
+  * many runs left the array unsorted
+  */
+ TimeResult time(const SortType type, int size, int times = 10, progress::Queue* log = nullptr)
+ {
+     TimeResult result;
+     Trace trace;
+     vector<int> arr(size);
+     vector<int> work(size);
+     iota(arr.begin(), arr.end(), 1);
      shuffle(begin(arr), end(arr), rnd);
      for (int i = 0; i < times; i++)
      {
-         cout << "Running " << type << " of size " << console::Modifier(console::FG_GREEN) << size << console::Modifier(console::FG_DEFAULT) << " , " << console::Modifier(console::FG_GREEN) << i + 1 << console::Modifier(console::FG_DEFAULT) << " out of " << console::Modifier(console::FG_BRIGHT_BLUE) << times << console::Modifier(console::FG_DEFAULT) << " times" << endl;
+         if (log != nullptr)
+             log->push({ type, size, i, times });
+         copy(arr.begin(), arr.end(), work.begin());
+         memory::begin_measure();
+         const long long live = memory::stats.live;
+         const size_t resident = memory::resident_bytes();
+         vector<int> scratch(scratch_size(type, size));
          auto startTime = high_resolution_clock::now();
-         sorted = sort(type, arr);
-         const double duration = static_cast<double>(duration_cast<microseconds>(high_resolution_clock::now() - startTime).count());
-         result[1] += duration;
-         if (result[0] < 0 || result[0] > duration)
-             result[0] = duration;
-         if (result[2] < duration)
-             result[2] = duration;
+         sort(type, work, scratch, trace);
+         const double duration = duration_cast<std::chrono::duration<double, micro>>(high_resolution_clock::now() - startTime).count();
+         result.allocations = max(result.allocations, memory::stats.allocations);
+         result.bytes = max(result.bytes, memory::stats.bytes);
+         result.peakHeap = max(result.peakHeap, memory::stats.peak - live);
+         result.rssGrowth = max(result.rssGrowth, max(memory::resident_bytes(), resident) - resident);
+         result.avg += duration;
+         if (result.min < 0 || result.min > duration)
+             result.min = duration;
+         if (result.max < duration)
+             result.max = duration;
+         if (!is_sorted(work.begin(), work.end()))
+             result.unsorted++;
          if (i != times - 1)
              shuffle(begin(arr), end(arr), rnd);
      }
-     if (debug)
-         print(sorted);
-     result[1] /= times;
+     if constexpr (debug)
+         print(work);
+     result.avg /= times;
+
+     CountingTrace counter;
+     vector<int> scratch(scratch_size(type, size));
+     copy(arr.begin(), arr.end(), work.begin());
+     sort(type, work, scratch, counter);
+     result.compares = counter.compares;
+     result.swaps = counter.swaps;
      return result;
  }
 
@@ -539,6 +861,13 @@
  int minLen = 0;
  int maxLen = 0;
  int avgLen = 0;
+ int comparesLen = 0;
+ int swapsLen = 0;
+ // These start at the length of their header, which is often longer than the values
+ int allocLen = 6;  // Allocs
+ int bytesLen = 5;  // Bytes
+ int peakLen = 9;   // Peak heap
+ int rssLen = 10;   // RSS growth
 
  string format_number(long long num)
  {
@@ -563,6 +892,20 @@
      return format_number(static_cast<long long>(time / 1000000)) + add + u8"s";
  }
 
+ string formatBytes(double bytes)
+ {
+     const char* units[] = { "B", "KiB", "MiB", "GiB" };
+     int unit = 0;
+     while (bytes >= 1024 && unit < 3)
+     {
+         bytes /= 1024;
+         unit++;
+     }
+     auto str = to_string(bytes);
+     str = str.substr(0, str.find('.') + (unit == 0 ? 0 : 3));
+     return str + " " + units[unit];
+ }
+
  string formatDouble(double num)
  {
      if (num < 1000)
@@ -572,16 +915,22 @@
      return to_string(num / 1000000 - static_cast<long long>(num / 1000000));
  }
 
- void formatTime(string name, vector<double> time, bool dry = false)
+ void formatTime(string name, const TimeResult& time, bool dry = false)
  {
-     const auto avg = time[1];
+     const auto avg = time.avg;
      auto avgDecStr = formatDouble(avg);
      avgDecStr = avgDecStr.substr(avgDecStr.find('.') + 1, 3);
      avgDecStr = avgDecStr.substr(0, avgDecStr.find_last_not_of('0') + 1);
 
-     const auto minStr = formatTime(time[0]);
-     const auto maxStr = formatTime(static_cast<long long>(time[2]));
+     const auto minStr = formatTime(time.min);
+     const auto maxStr = formatTime(static_cast<long long>(time.max));
      const auto avgStr = formatTime(static_cast<long long>(avg), avgDecStr);
+     const auto comparesStr = format_number(time.compares);
+     const auto swapsStr = format_number(time.swaps);
+     const auto allocStr = format_number(time.allocations);
+     const auto bytesStr = formatBytes(static_cast<double>(time.bytes));
+     const auto peakStr = formatBytes(static_cast<double>(time.peakHeap));
+     const auto rssStr = formatBytes(static_cast<double>(time.rssGrowth));
      if (!dry)
      {
          printElement(name, nameLen);
@@ -591,6 +940,18 @@
          printElement(maxStr, maxLen, true, console::Modifier(console::FG_BRIGHT_ORANGE));
          cout << " | ";
          printElement(avgStr, avgLen, true, console::Modifier(console::FG_BRIGHT_MAGENTA));
+         cout << " | ";
+         printElement(comparesStr, comparesLen, true);
+         cout << " | ";
+         printElement(swapsStr, swapsLen, true);
+         cout << " | ";
+         printElement(allocStr, allocLen, true);
+         cout << " | ";
+         printElement(bytesStr, bytesLen, true);
+         cout << " | ";
+         printElement(peakStr, peakLen, true);
+         cout << " | ";
+         printElement(rssStr, rssLen, true);
          cout << endl;
      }
      else
@@ -598,72 +959,406 @@
          minLen = max(minLen, static_cast<int>(minStr.length()));
          maxLen = max(maxLen, static_cast<int>(maxStr.length()));
          avgLen = max(avgLen, static_cast<int>(avgStr.length()));
+         comparesLen = max(comparesLen, static_cast<int>(comparesStr.length()));
+         swapsLen = max(swapsLen, static_cast<int>(swapsStr.length()));
+         allocLen = max(allocLen, static_cast<int>(allocStr.length()));
+         bytesLen = max(bytesLen, static_cast<int>(bytesStr.length()));
+         peakLen = max(peakLen, static_cast<int>(peakStr.length()));
+         rssLen = max(rssLen, static_cast<int>(rssStr.length()));
          nameLen = max(nameLen, static_cast<int>(name.length()));
      }
  }
 
- int main()
+ /**
+  * @brief Gets the sizes of the data caches
+  *
+  * @return The L1, L2 and L3 data cache sizes in bytes, 0 for a level that is not present
+  */
+ array<size_t, 3> cache_sizes()
+ {
+     array<size_t, 3> sizes{};
+     DWORD length = 0;
+     GetLogicalProcessorInformation(nullptr, &length);
+     vector<SYSTEM_LOGICAL_PROCESSOR_INFORMATION> info(length / sizeof(SYSTEM_LOGICAL_PROCESSOR_INFORMATION));
+     if (info.empty() || !GetLogicalProcessorInformation(info.data(), &length))
+         return sizes;
+     for (const auto& entry : info)
+     {
+         if (entry.Relationship != RelationCache || entry.Cache.Type == CacheInstruction)
+             continue;
+         const int level = entry.Cache.Level;
+         if (level >= 1 && level <= 3)
+             sizes[level - 1] = max(sizes[level - 1], static_cast<size_t>(entry.Cache.Size));
+     }
+     return sizes;
+ }
+
+ /**
+  * @brief Fits time = c * n^k with least squares in log-log space
+  *
+  * @param sizes The array sizes
+  * @param times The times for each size
+  * @return The exponent k
+  */
+ double fit_exponent(const vector<double>& sizes, const vector<double>& times)
+ {
+     double sumX = 0, sumY = 0, sumXX = 0, sumXY = 0;
+     const auto count = static_cast<double>(sizes.size());
+     for (size_t i = 0; i < sizes.size(); ++i)
+     {
+         const double x = log(sizes[i]);
+         const double y = log(times[i]);
+         sumX += x;
+         sumY += y;
+         sumXX += x * x;
+         sumXY += x * y;
+     }
+     const double denominator = count * sumXX - sumX * sumX;
+     if (count < 2 || denominator == 0)
+         return 0;
+     return (count * sumXY - sumX * sumY) / denominator;
+ }
+
+ /**
+  * @brief Gets the exponent an algorithm should scale with on random input
+  *
+  * n log n is counted as 1 since the logarithm only adds a few hundredths to the fitted exponent.
+  */
+ double expected_exponent(const SortType type)
+ {
+     switch (type)
+     {
+     case BubbleSort:
+     case InsertionSort:
+     case SelectionSort:
+     case CocktailSort:
+         return 2;
+     default:
+         return 1;
+     }
+ }
+
+ /**
+  * @brief Times an algorithm over geometrically growing sizes and estimates how it scales
+  *
+  * The size grows by a factor of √2 from 16 until the working set (array plus scratch) passes
+  * maxBytes or a single sort takes longer than budget. Each size is run until it has taken at
+  * least 20ms in total (and at least 3 times) and the fastest run is kept. The rows show the
+  * time per element and per element per log2(n), and a line marks where the working set
+  * outgrows each cache level. At the end a power law is fitted to the times of at least 1µs and
+  * compared with the exponent the algorithm should have.
+  *
+  * @param type The algorithm to sweep
+  * @param maxBytes The largest working set to try
+  * @param budget The longest a single sort may take before the sweep stops growing
+  * @param caches The L1, L2 and L3 cache sizes
+  */
+ void sweep(const SortType type, const size_t maxBytes, const double budget, const array<size_t, 3>& caches)
+ {
+     cout << endl << console::Modifier(console::FG_BRIGHT_BLUE) << type << console::Modifier(console::FG_DEFAULT) << endl;
+     printElement("n", 14, true);
+     cout << " | ";
+     printElement("Working set", 12, true);
+     cout << " | ";
+     printElement("Time", 12, true);
+     cout << " | ";
+     printElement("ns/n", 10, true);
+     cout << " | ";
+     printElement("ns/(n log n)", 12, true);
+     cout << endl;
+
+     vector<double> sizes;
+     vector<double> times;
+     int cacheLevel = 0;
+     for (double next = 16; ; next *= sqrt(2.0))
+     {
+         const int size = static_cast<int>(next);
+         const size_t workingSet = (size + scratch_size(type, size)) * sizeof(int);
+         if (workingSet > maxBytes)
+             break;
+         while (cacheLevel < 3 && (caches[cacheLevel] == 0 || workingSet > caches[cacheLevel]))
+         {
+             if (caches[cacheLevel] != 0)
+                 cout << console::Modifier(console::FG_ORANGE) << "-- working set leaves L" << cacheLevel + 1 << " (" << formatBytes(static_cast<double>(caches[cacheLevel])) << ")" << console::Modifier(console::FG_DEFAULT) << endl;
+             cacheLevel++;
+         }
+
+         vector<int> arr(size);
+         vector<int> work(size);
+         vector<int> scratch(scratch_size(type, size));
+         iota(arr.begin(), arr.end(), 1);
+         double best = -1, total = 0;
+         for (int run = 0; run < 3 || total < 20000; ++run)
+         {
+             shuffle(begin(arr), end(arr), rnd);
+             copy(arr.begin(), arr.end(), work.begin());
+             auto startTime = high_resolution_clock::now();
+             sort(type, work, scratch);
+             const double duration = duration_cast<std::chrono::duration<double, micro>>(high_resolution_clock::now() - startTime).count();
+             total += duration;
+             if (best < 0 || duration < best)
+                 best = duration;
+             if (duration > budget)
+                 break;
+         }
+
+         const double perElement = best * 1000 / size;
+         printElement(format_number(size), 14, true);
+         cout << " | ";
+         printElement(formatBytes(static_cast<double>(workingSet)), 12, true);
+         cout << " | ";
+         printElement(formatTime(best), 12, true, console::Modifier(console::FG_BRIGHT_CYAN));
+         cout << " | ";
+         printElement(perElement, 10, true);
+         cout << " | ";
+         printElement(perElement / log2(size), 12, true);
+         cout << endl;
+
+         if (best >= 1)
+         {
+             sizes.push_back(size);
+             times.push_back(best);
+         }
+         if (best > budget)
+             break;
+     }
+
+     const double exponent = fit_exponent(sizes, times);
+     const double expected = expected_exponent(type);
+     const bool suspicious = exponent > expected + 0.3;
+     cout << "Fitted exponent: " << console::Modifier(suspicious ? console::FG_RED : console::FG_GREEN) << exponent << console::Modifier(console::FG_DEFAULT) << " (expected about " << expected << ")";
+     if (suspicious)
+         cout << console::Modifier(console::FG_RED) << " scales worse than it should" << console::Modifier(console::FG_DEFAULT);
+     cout << endl;
+ }
+
+ // Not declared by any Windows header, CallNtPowerInformation fills one per logical processor
+ struct PROCESSOR_POWER_INFORMATION
+ {
+     ULONG Number;
+     ULONG MaxMhz;
+     ULONG CurrentMhz;
+     ULONG MhzLimit;
+     ULONG MaxIdleState;
+     ULONG CurrentIdleState;
+ };
+
+ /**
+  * @brief Picks the logical processors benchmarks may be pinned to
+  *
+  * Only the first logical processor of every physical core is used so two benchmarks never
+  * share a core through SMT, and the first reserve physical cores are left for the OS and the
+  * console.
+  *
+  * @param reserve How many physical cores to keep free
+  * @param smt Set to true if any core has more than one logical processor
+  * @return An affinity mask with a single bit for each usable logical processor, empty if the
+  * reserve covers every core
+  */
+ vector<DWORD_PTR> usable_cores(const int reserve, bool& smt)
+ {
+     vector<DWORD_PTR> cores;
+     smt = false;
+     DWORD length = 0;
+     GetLogicalProcessorInformation(nullptr, &length);
+     vector<SYSTEM_LOGICAL_PROCESSOR_INFORMATION> info(length / sizeof(SYSTEM_LOGICAL_PROCESSOR_INFORMATION));
+     if (info.empty() || !GetLogicalProcessorInformation(info.data(), &length))
+         return { 1 };
+     int skipped = 0;
+     for (const auto& entry : info)
+     {
+         if (entry.Relationship != RelationProcessorCore)
+             continue;
+         const DWORD_PTR mask = entry.ProcessorMask;
+         if ((mask & (mask - 1)) != 0)
+             smt = true;
+         if (skipped++ < reserve)
+             continue;
+         cores.push_back(mask & ~(mask - 1));
+     }
+     return cores;
+ }
+
+ /**
+  * @brief Warns about setups that make the timings noisy
+  *
+  * The current clock of an idle core is almost always below the maximum because of power
+  * saving, so only a clock limit below the maximum (a power plan cap or thermal throttling)
+  * counts as frequency scaling.
+  *
+  * @param smt If any core has SMT siblings
+  * @param jobs How many benchmarks run at the same time
+  */
+ void warn_about_noise(const bool smt, const int jobs)
+ {
+     const console::Modifier orange(console::FG_ORANGE);
+     const console::Modifier def(console::FG_DEFAULT);
+     SYSTEM_INFO system;
+     GetSystemInfo(&system);
+     vector<PROCESSOR_POWER_INFORMATION> power(system.dwNumberOfProcessors);
+     if (CallNtPowerInformation(ProcessorInformation, nullptr, 0, power.data(), static_cast<ULONG>(power.size() * sizeof(PROCESSOR_POWER_INFORMATION))) == 0)
+     {
+         for (const auto& processor : power)
+         {
+             if (processor.MhzLimit < processor.MaxMhz)
+             {
+                 cout << orange << "Warning: processor " << processor.Number << " is limited to " << processor.MhzLimit << " of " << processor.MaxMhz << " MHz, the power plan or throttling will add noise" << def << endl;
+                 break;
+             }
+         }
+     }
+     if (smt)
+         cout << orange << "Warning: SMT is enabled, benchmarks only use one logical processor per core but the siblings can still be busy with other work" << def << endl;
+     if (jobs > 1)
+         cout << orange << "Warning: " << jobs << " benchmarks share the L3 cache and memory bandwidth, compare results from the same job count only" << def << endl;
+ }
+
+ /**
+  * @brief One algorithm and size in the benchmark matrix
+  */
+ struct BenchmarkCase
+ {
+     SortType type;
+     int size;
+     bool printed = true;
+     TimeResult result;
+ };
+
+ /**
+  * @brief Runs the benchmark cases on pinned worker threads
+  *
+  * Every worker is pinned to its own core and takes the next case from a shared counter. The
+  * cases are handed out most expensive first (by the expected exponent of the algorithm) so the
+  * long ones do not end up last on a single core.
+  *
+  * @param cases The cases to run, the results are written back into them
+  * @param cores The affinity masks to pin the workers to, one worker per mask
+  * @param quiet If the progress messages should be left out
+  */
+ void run_cases(vector<BenchmarkCase>& cases, const vector<DWORD_PTR>& cores, const bool quiet)
+ {
+     vector<size_t> order(cases.size());
+     iota(order.begin(), order.end(), 0);
+     stable_sort(order.begin(), order.end(), [&cases](const size_t a, const size_t b)
+     {
+         return pow(cases[a].size, expected_exponent(cases[a].type)) > pow(cases[b].size, expected_exponent(cases[b].type));
+     });
+
+     const auto logger = quiet ? nullptr : make_unique<progress::Logger>(cores.size());
+     atomic<size_t> next = 0;
+     vector<thread> workers;
+     for (size_t worker = 0; worker < cores.size(); ++worker)
+     {
+         progress::Queue* log = logger ? &logger->queue(worker) : nullptr;
+         workers.emplace_back([&cases, &order, &next, core = cores[worker], log]
+         {
+             SetThreadAffinityMask(GetCurrentThread(), core);
+             for (size_t i = next++; i < order.size(); i = next++)
+             {
+                 auto& benchmark = cases[order[i]];
+                 benchmark.result = time(benchmark.type, benchmark.size, 10, log);
+             }
+         });
+     }
+     for (auto& worker : workers)
+         worker.join();
+
+     // Reported here rather than through the progress queues, which drop records when they are full
+     for (const auto& benchmark : cases)
+     {
+         if (benchmark.result.unsorted > 0)
+             cerr << console::Modifier(console::FG_RED) << benchmark.type << " left " << benchmark.result.unsorted << " of 10 arrays of size " << benchmark.size << " unsorted" << console::Modifier(console::FG_DEFAULT) << endl;
+     }
+ }
+
+ /**
+  * @brief Gets the name of an algorithm with spaces, as it is shown in the table
+  */
+ string display_name(const SortType type)
+ {
+     ostringstream stream;
+     stream << type;
+     string name = stream.str();
+     for (size_t i = 1; i < name.size(); ++i)
+     {
+         if (isupper(static_cast<unsigned char>(name[i])))
+             name.insert(i++, " ");
+     }
+     return name;
+ }
+
+ int main(int argc, char* argv[])
  {
      SetConsoleOutputCP(CP_UTF8);
      setvbuf(stdout, nullptr, _IOFBF, 1000);
      cout.imbue(locale(""));
 
-     auto bubble100 = time(BubbleSort, 100);
-     auto bubble1000 = time(BubbleSort, 1000);
-     auto bubble10000 = time(BubbleSort, 10000);
-
-     auto insertion100 = time(InsertionSort, 100);
-     auto insertion1000 = time(InsertionSort, 1000);
-     auto insertion10000 = time(InsertionSort, 10000);
-
-     auto selection100 = time(SelectionSort, 100);
-     auto selection1000 = time(SelectionSort, 1000);
-     auto selection10000 = time(SelectionSort, 10000);
-
-     auto merge100 = time(MergeSort, 100);
-     auto merge1000 = time(MergeSort, 1000);
-     auto merge10000 = time(MergeSort, 10000);
-     auto merge100000 = time(MergeSort, 100000);
-
-     auto quick100 = time(QuickSort, 100);
-     auto quick1000 = time(QuickSort, 1000);
-     auto quick10000 = time(QuickSort, 10000);
-     auto quick100000 = time(QuickSort, 100000);
-
-     auto cocktail100 = time(CocktailSort, 100);
-     auto cocktail1000 = time(CocktailSort, 1000);
-     auto cocktail10000 = time(CocktailSort, 10000);
-
-     auto heap100 = time(HeapSort, 100);
-     auto heap1000 = time(HeapSort, 1000);
-     auto heap10000 = time(HeapSort, 10000);
-     auto heap100000 = time(HeapSort, 100000);
-
-     auto intro100 = time(IntroSort, 100);
-     auto intro1000 = time(IntroSort, 1000);
-     auto intro10000 = time(IntroSort, 10000);
-     auto intro100000 = time(IntroSort, 100000);
-
-     auto radix100 = time(RadixSort, 100);
-     auto radix1000 = time(RadixSort, 1000);
-     auto radix10000 = time(RadixSort, 10000);
-     auto radix100000 = time(RadixSort, 100000);
-     auto radix1000000 = time(RadixSort, 1000000);
-     auto radix10000000 = time(RadixSort, 10000000);
+     // --sweep [max MiB]  runs the complexity sweep for every algorithm instead of the fixed sizes
+     // --jobs N           runs up to N benchmark cases at the same time, each on its own core
+     // --reserve N        keeps the first N physical cores free of benchmarks
+     // --quiet            leaves out the progress messages
+     bool sweepMode = false;
+     bool quiet = false;
+     size_t sweepMiB = 256;
+     int jobs = 1;
+     int reserve = 0;
+     for (int i = 1; i < argc; ++i)
+     {
+         const string arg = argv[i];
+         if (arg == "--sweep")
+         {
+             sweepMode = true;
+             if (i + 1 < argc && isdigit(static_cast<unsigned char>(argv[i + 1][0])))
+                 sweepMiB = stoull(argv[++i]);
+         }
+         else if (arg == "--jobs" && i + 1 < argc)
+             jobs = max(1, stoi(argv[++i]));
+         else if (arg == "--reserve" && i + 1 < argc)
+             reserve = max(0, stoi(argv[++i]));
+         else if (arg == "--quiet")
+             quiet = true;
+     }
+
+     bool smt;
+     auto cores = usable_cores(reserve, smt);
+     if (cores.empty())
+     {
+         cerr << "--reserve " << reserve << " leaves no physical core for the benchmarks" << endl;
+         return 1;
+     }
+     if (static_cast<int>(cores.size()) > jobs)
+         cores.resize(jobs);
+     warn_about_noise(smt, static_cast<int>(cores.size()));
+
+     if (sweepMode)
+     {
+         SetThreadAffinityMask(GetCurrentThread(), cores[0]);
+         const auto caches = cache_sizes();
+         for (int type = BubbleSort; type <= RadixSort; ++type)
+             sweep(static_cast<SortType>(type), sweepMiB * 1024 * 1024, 2000000, caches);
+         return 0;
+     }
+
+     // The rows that are not printed are the biggest size of each algorithm, they still set the column widths
+     vector<BenchmarkCase> cases = {
+         { BubbleSort, 100 }, { BubbleSort, 1000 }, { BubbleSort, 10000, false },
+         { InsertionSort, 100 }, { InsertionSort, 1000 }, { InsertionSort, 10000, false },
+         { SelectionSort, 100 }, { SelectionSort, 1000 }, { SelectionSort, 10000, false },
+         { MergeSort, 100 }, { MergeSort, 1000 }, { MergeSort, 10000 }, { MergeSort, 100000, false },
+         { QuickSort, 100 }, { QuickSort, 1000 }, { QuickSort, 10000 }, { QuickSort, 100000, false },
+         { CocktailSort, 100 }, { CocktailSort, 1000 }, { CocktailSort, 10000, false },
+         { HeapSort, 100 }, { HeapSort, 1000 }, { HeapSort, 10000 }, { HeapSort, 100000, false },
+         { IntroSort, 100 }, { IntroSort, 1000 }, { IntroSort, 10000 }, { IntroSort, 100000, false },
+         { RadixSort, 100 }, { RadixSort, 1000 }, { RadixSort, 10000 }, { RadixSort, 100000 }, { RadixSort, 1000000 }, { RadixSort, 10000000, false },
+     };
+     run_cases(cases, cores, quiet);
 
      cout << endl;
      cout << endl;
      cout << endl;
 
-     formatTime("Bubble Sort 10000", bubble10000, true);
-     formatTime("Insertion Sort 10000", insertion10000, true);
-     formatTime("Selection Sort 10000", selection10000, true);
-     formatTime("Merge Sort 100000", merge100000, true);
-     formatTime("Quick Sort 100000", quick100000, true);
-     formatTime("Cocktail Sort 10000", cocktail10000, true);
-     formatTime("Heap Sort 100000", heap100000, true);
-     formatTime("Intro Sort 100000", intro100000, true);
-     formatTime("Radix Sort 10000000", radix10000000, true);
+     for (const auto& benchmark : cases)
+         formatTime(display_name(benchmark.type) + " " + to_string(benchmark.size), benchmark.result, true);
 
      printElement("Type", nameLen);
      cout << " | ";
@@ -672,50 +1367,25 @@
      printElement("Max", maxLen);
      cout << "| ";
      printElement("Avg", avgLen);
+     cout << "| ";
+     printElement("Compares", comparesLen);
+     cout << "| ";
+     printElement("Swaps", swapsLen);
+     cout << "| ";
+     printElement("Allocs", allocLen);
+     cout << "| ";
+     printElement("Bytes", bytesLen);
+     cout << "| ";
+     printElement("Peak heap", peakLen);
+     cout << "| ";
+     printElement("RSS growth", rssLen);
      cout << endl;
 
-     formatTime("Bubble Sort 100", bubble100);
-     formatTime("Bubble Sort 1000", bubble1000);
-     // formatTime("Bubble Sort 10000", bubble10000);
-
-     formatTime("Insertion Sort 100", insertion100);
-     formatTime("Insertion Sort 1000", insertion1000);
-     // formatTime("Insertion Sort 10000", insertion10000);
-
-     formatTime("Selection Sort 100", selection100);
-     formatTime("Selection Sort 1000", selection1000);
-     // formatTime("Selection Sort 10000", selection10000);
-
-     formatTime("Merge Sort 100", merge100);
-     formatTime("Merge Sort 1000", merge1000);
-     formatTime("Merge Sort 10000", merge10000);
-     // formatTime("Merge Sort 100000", merge100000);
-
-     formatTime("Quick Sort 100", quick100);
-     formatTime("Quick Sort 1000", quick1000);
-     formatTime("Quick Sort 10000", quick10000);
-     // formatTime("Quick Sort 100000", quick100000);
-
-     formatTime("Cocktail Sort 100", cocktail100);
-     formatTime("Cocktail Sort 1000", cocktail1000);
-     // formatTime("Cocktail Sort 10000", cocktail10000);
-
-     formatTime("Heap Sort 100", heap100);
-     formatTime("Heap Sort 1000", heap1000);
-     formatTime("Heap Sort 10000", heap10000);
-     // formatTime("Heap Sort 100000", heap100000);
-
-     formatTime("Intro Sort 100", intro100);
-     formatTime("Intro Sort 1000", intro1000);
-     formatTime("Intro Sort 10000", intro10000);
-     // formatTime("Intro Sort 100000", intro100000);
-
-     formatTime("Radix Sort 100", radix100);
-     formatTime("Radix Sort 1000", radix1000);
-     formatTime("Radix Sort 10000", radix10000);
-     formatTime("Radix Sort 100000", radix100000);
-     formatTime("Radix Sort 1000000", radix1000000);
-     // formatTime("Radix Sort 10000000", radix10000000);
+     for (const auto& benchmark : cases)
+     {
+         if (benchmark.printed)
+             formatTime(display_name(benchmark.type) + " " + to_string(benchmark.size), benchmark.result);
+     }
 
      return 0;
- }
\ No newline at end of file
+ }